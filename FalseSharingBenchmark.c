@@ -0,0 +1,166 @@
+/*
+* FalseSharingBenchmark
+*
+* Measures the cost of false sharing between per-thread counters. Every thread
+* increments only its own counter; in the packed layout the counters share
+* cache lines, in the padded layout each counter owns a full cache line.
+*
+* Compile: gcc -g -Wall -o FalseSharingBenchmark FalseSharingBenchmark.c -lpthread -lm
+* Run : FalseSharingBenchmark <threadCount> <iterations>
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <math.h>
+
+#define MAX_THREAD_COUNT 1024
+#define CACHE_LINE_SIZE 64
+#define PACKED 0
+#define PADDED 1
+
+int threadCount = 0;
+long iterations;        // number of increments done by each thread
+int sampleSize = 35;    // number of samples considered
+
+// counter padded to a full cache line
+struct padded_counter_s
+{
+    long value;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+long packedCounters[MAX_THREAD_COUNT];
+struct padded_counter_s paddedCounters[MAX_THREAD_COUNT];
+
+void getArgs (int argc, char *argv[]);
+
+void *packedExecute (void *id);
+
+void *paddedExecute (void *id);
+
+double runSample (int layout);
+
+float calculateSTD (double data[], float mean);
+
+int main (int argc, char *argv[])
+{
+    double packedTimeArray[sampleSize];
+    double paddedTimeArray[sampleSize];
+    double packedTotalTime = 0.0;
+    double paddedTotalTime = 0.0;
+
+    getArgs(argc, argv);
+
+    for (int j = 0; j < sampleSize; j++)
+    {
+        packedTimeArray[j] = runSample(PACKED);
+        packedTotalTime += packedTimeArray[j];
+
+        paddedTimeArray[j] = runSample(PADDED);
+        paddedTotalTime += paddedTimeArray[j];
+    }
+
+    float packedMean = packedTotalTime / sampleSize;
+    float paddedMean = paddedTotalTime / sampleSize;
+    double totalIncrements = (double) iterations * threadCount;
+
+    printf ("Packed Mean : %f\n", packedMean);
+    printf ("Packed STD : %f\n", calculateSTD(packedTimeArray, packedMean));
+    printf ("Padded Mean : %f\n", paddedMean);
+    printf ("Padded STD : %f\n", calculateSTD(paddedTimeArray, paddedMean));
+    printf ("Packed Throughput : %.0f increments/s\n", totalIncrements / packedMean);
+    printf ("Padded Throughput : %.0f increments/s\n", totalIncrements / paddedMean);
+    printf ("Speedup : %f\n", packedMean / paddedMean);
+
+    return 0;
+}
+
+// runs all threads over one counter layout and returns the elapsed wall time
+double runSample (int layout)
+{
+    pthread_t* threadHandler = malloc(sizeof(pthread_t) * threadCount);
+    int *threadID = (int *)malloc(sizeof(int) * threadCount);
+    struct timespec startTime, endTime;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        packedCounters[i] = 0;
+        paddedCounters[i].value = 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        threadID[i] = i;
+        pthread_create(&threadHandler[i], NULL, layout == PACKED ? packedExecute : paddedExecute, (void *) &threadID[i]);
+    }
+
+    for (int i = 0; i < threadCount; i++)
+        pthread_join(threadHandler[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    free(threadHandler);
+    free(threadID);
+
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void *packedExecute (void *thread_id)
+{
+    int id = *(int *) thread_id;
+
+    // atomic increments force the cache line to be owned by the writing core
+    for (long i = 0; i < iterations; i++)
+        __atomic_fetch_add(&packedCounters[id], 1, __ATOMIC_RELAXED);
+
+    return NULL;
+}
+
+void *paddedExecute (void *thread_id)
+{
+    int id = *(int *) thread_id;
+
+    for (long i = 0; i < iterations; i++)
+        __atomic_fetch_add(&paddedCounters[id].value, 1, __ATOMIC_RELAXED);
+
+    return NULL;
+}
+
+void getArgs (int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        printf("Enter FalseSharingBenchmark <threadCount> <iterations> \n");
+        exit(0);
+    }
+
+    threadCount = (int) strtol(argv[1], (char **) NULL, 10);
+    iterations = strtol(argv[2], (char **) NULL, 10);
+
+    // validating thread count
+    if (threadCount <= 0 || threadCount > MAX_THREAD_COUNT)
+    {
+        printf ("Thread count is incorrect \n");
+        exit(0);
+    }
+
+    if (iterations <= 0)
+    {
+        printf ("Value you entered for iterations is incorrect! \n");
+        exit(0);
+    }
+}
+
+float calculateSTD (double data[], float mean)
+{
+    float standardDeviation = 0.0;
+
+    for (int i = 0; i < sampleSize; ++i)
+        standardDeviation += pow(data[i] - mean, 2);
+
+    return sqrt(standardDeviation / sampleSize);
+}
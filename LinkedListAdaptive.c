@@ -0,0 +1,967 @@
+/*
+* LinkedListAdaptive
+*
+* List whose locking scheme follows the workload. A monitor thread looks at
+* the read/write mix, the lock contention and the throughput of the last
+* interval and moves the list between a global mutex, a read-write lock and
+* fine-grained (hand-over-hand, one mutex per node) locking.
+*
+* Each scheme counts contention in its own unit, so the counts are never
+* compared across schemes; they only propose a switch away from the current
+* one:
+*
+*   mutex, contended        -> read-write lock when read-mostly, else fine-grained
+*   read-write lock         -> mutex once the mix is no longer read-mostly
+*                              (readers hardly ever find the lock busy, so read
+*                              contention says nothing)
+*   fine-grained            -> read-write lock when read-mostly, mutex when the
+*                              head mutex is quiet
+*
+* A proposed scheme is tried for a few intervals and kept only when its
+* throughput is at least that of the scheme it replaced on the same mix.
+* Otherwise the list goes back and the same switch is not tried again for a
+* backoff that doubles with every rejection, or until the mix changes. A trial
+* whose mix moved away from the one it is compared with proves nothing, so
+* the list goes back without a backoff.
+*
+* A switch only happens at a quiescent point: every worker parks before its
+* next operation and the scheme is changed while none of them is inside one.
+* The per-node mutexes only exist while the fine-grained scheme runs; they
+* are allocated when it is entered and freed when it is left.
+*
+* The positional fractions are the first phase of the workload; every -p adds
+* another phase of m operations with its own fractions.
+*
+* Compile: gcc -g -Wall -o LinkedListAdaptive LinkedListAdaptive.c -lpthread -lm
+* Run : LinkedListAdaptive [-e mutex|rwlock|fine] [-f] [-p <mMember>,<mInsert>,<mDelete>]... <n> <m> <threadCount> <mMember> <mIsert> <mDelete>
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <math.h>
+
+#define MAX_RANDOM_NUMBER 65535
+#define MAX_THREAD_COUNT 1024
+#define MAX_PHASE_COUNT 16
+#define CACHE_LINE_SIZE 64
+#define MEMBER 0
+#define INSERT 1
+#define DELETE 2
+#define MODE_MUTEX 0
+#define MODE_RWLOCK 1
+#define MODE_FINE 2
+#define MODE_COUNT 3
+#define MONITOR_INTERVAL 0.01       // seconds between two looks at the workload
+#define MIN_WINDOW_OPERATIONS 100   // fewer operations than this say nothing about the mix
+#define STABLE_WINDOWS 5            // intervals a proposal has to hold before it is tried
+#define TRIAL_WINDOWS 5             // intervals a tried scheme runs before it is judged
+#define MIN_DWELL_WINDOWS 20        // intervals a scheme is kept after a switch
+#define RETRY_WINDOWS 50            // intervals before a rejected switch is tried again, doubled per rejection
+#define MAX_RETRY_WINDOWS 3200
+#define MIX_CHANGE 0.1              // change of the write fraction that makes a measurement stale
+#define MIX_SMOOTHING 0.2           // weight of the newest interval in the smoothed write fraction
+#define LOW_CONTENTION 0.05         // fraction of lock attempts that found the lock busy
+#define READ_MOSTLY 0.2             // highest write fraction served by the read-write lock
+
+int n; // number of nodes in the linked list
+int m; // number of random operations per phase
+int threadCount = 0;
+int initialMode = MODE_MUTEX;
+int fixedMode = 0;      // keep the initial scheme, for comparison
+
+// Fractions of each operations, one set per phase
+int phaseCount = 1;
+float mMemberFrac[MAX_PHASE_COUNT], mInsertFrac[MAX_PHASE_COUNT], mDeleteFrac[MAX_PHASE_COUNT];
+
+const char *modeNames[MODE_COUNT] = { "mutex", "rwlock", "fine" };
+
+// node definition, the mutex is only allocated while the fine-grained scheme runs
+struct list_node_s
+{
+    int data;
+    struct list_node_s *next;
+    pthread_mutex_t *mutex;
+};
+
+// per-thread statistics read by the monitor, padded to a full cache line
+struct thread_counter_s
+{
+    long reads;
+    long writes;
+    long contended;     // lock attempts that found the lock held
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// the scheme in use and the switching protocol between monitor and workers
+struct adaptive_state_s
+{
+    int mode;
+    int switchRequested;    // workers park before their next operation while set
+    int parkedCount;
+    int finishedCount;
+    pthread_mutex_t mutex;
+    pthread_cond_t parked;      // signalled when a worker parks or finishes
+    pthread_cond_t resumed;     // broadcast once the new scheme is in place
+    int switchCount;
+    int rejectedCount;      // tried schemes that lost against the one they replaced
+    double modeTime[MODE_COUNT];
+    struct timespec modeStart;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// operations, writes and time of the intervals the monitor has measured
+struct window_measure_s
+{
+    long operations;
+    long writes;
+    double seconds;
+};
+
+// each lock gets a cache line of its own
+struct padded_locks_s
+{
+    pthread_mutex_t mutex __attribute__((aligned(CACHE_LINE_SIZE)));
+    pthread_rwlock_t rwlock __attribute__((aligned(CACHE_LINE_SIZE)));
+    pthread_mutex_t headMutex __attribute__((aligned(CACHE_LINE_SIZE)));
+};
+
+struct list_node_s *head = NULL;
+struct adaptive_state_s state;
+struct padded_locks_s locks;
+struct thread_counter_s threadCounters[MAX_THREAD_COUNT];
+
+int member (int value, struct list_node_s* head_p);
+
+int insert (int value, struct list_node_s** head_pp);
+
+int delete (int value, struct list_node_s** head_pp);
+
+int memberFine (int value, struct thread_counter_s *counter);
+
+int insertFine (int value, struct thread_counter_s *counter);
+
+int deleteFine (int value, struct thread_counter_s *counter);
+
+void lockHead (struct thread_counter_s *counter);
+
+struct list_node_s *newNode (int value);
+
+pthread_mutex_t *newNodeLock ();
+
+void freeNode (struct list_node_s *node);
+
+void attachNodeLocks ();
+
+void detachNodeLocks ();
+
+void executeOperation (int operation, int value, struct thread_counter_s *counter);
+
+void parkWorker ();
+
+void *monitorExecute ();
+
+int proposeMode (int mode, long reads, long writes, long contended);
+
+void switchMode (int mode);
+
+void getArgs (int argc, char *argv[]);
+
+void parsePhase (char *phase);
+
+void *threadExecute (void *id);
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime);
+
+void sleepSeconds (double seconds);
+
+void deleteLinkedList (struct list_node_s** head_pp);
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id);
+
+int main (int argc, char *argv[])
+{
+    struct timespec startTime, endTime;
+
+    getArgs(argc, argv);
+
+    // Linked list generation with non-repeat random numbers
+    for (int i =0; i < n; i++)
+    {
+        if (!insert(rand() % MAX_RANDOM_NUMBER, &head))
+            i--;
+    }
+
+    pthread_mutex_init(&locks.mutex, NULL);
+    pthread_rwlock_init(&locks.rwlock, NULL);
+    pthread_mutex_init(&locks.headMutex, NULL);
+    pthread_mutex_init(&state.mutex, NULL);
+    pthread_cond_init(&state.parked, NULL);
+    pthread_cond_init(&state.resumed, NULL);
+    state.mode = initialMode;
+    if (initialMode == MODE_FINE)
+        attachNodeLocks();
+
+    pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+    int *threadID = (int *)malloc(sizeof(int) * threadCount);
+    pthread_t monitor;
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        threadID[i] = i;
+        pthread_create(&threadHandler[i], NULL, (void *) threadExecute, (void *) &threadID[i]);
+    }
+    pthread_create(&monitor, NULL, (void *) monitorExecute, NULL);
+
+    for (int i = 0; i < threadCount; i++)
+        pthread_join(threadHandler[i], NULL);
+    pthread_join(monitor, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    double runTime = elapsedSeconds(startTime, endTime);
+    printf ("Time : %f\n", runTime);
+    printf ("Throughput : %f\n", (double) m * phaseCount / runTime);
+    printf ("Mode Switches : %d\n", state.switchCount);
+    printf ("Rejected Switches : %d\n", state.rejectedCount);
+
+    for (int i = 0; i < MODE_COUNT; i++)
+        printf ("Time In %s : %f\n", modeNames[i], state.modeTime[i]);
+
+    pthread_mutex_destroy(&locks.mutex);
+    pthread_rwlock_destroy(&locks.rwlock);
+    pthread_mutex_destroy(&locks.headMutex);
+    pthread_mutex_destroy(&state.mutex);
+    pthread_cond_destroy(&state.parked);
+    pthread_cond_destroy(&state.resumed);
+
+    deleteLinkedList(&head);
+    free(threadHandler);
+    free(threadID);
+
+    return 0;
+}
+
+int member (int value, struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+
+    while (curr_p != NULL && curr_p->data < value)
+        curr_p = curr_p->next;
+
+    if (curr_p == NULL || curr_p->data > value)
+    {
+        return 0;
+    }
+    else
+    {
+       return 1;
+    }
+
+};
+
+int insert (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+    struct list_node_s* temp_p;
+
+    while (curr_p != NULL && curr_p->data <value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p == NULL || curr_p->data >value)
+    {
+        temp_p = newNode(value);
+        temp_p->next = curr_p;
+
+        if (pred_p == NULL)
+            *head_pp = temp_p;
+        else
+            pred_p->next = temp_p;
+
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+int delete (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p != NULL && curr_p->data == value)
+    {
+        if (pred_p == NULL)
+            *head_pp = curr_p->next;
+        else
+            pred_p->next = curr_p->next;
+
+        freeNode(curr_p);
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+// hand-over-hand traversal: the next node is locked before the current one is released
+int memberFine (int value, struct thread_counter_s *counter)
+{
+    struct list_node_s* curr_p;
+    struct list_node_s* next_p;
+    int result;
+
+    lockHead(counter);
+    curr_p = head;
+    if (curr_p != NULL)
+        pthread_mutex_lock(curr_p->mutex);
+    pthread_mutex_unlock(&locks.headMutex);
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        next_p = curr_p->next;
+        if (next_p != NULL)
+            pthread_mutex_lock(next_p->mutex);
+        pthread_mutex_unlock(curr_p->mutex);
+        curr_p = next_p;
+    }
+
+    result = curr_p != NULL && curr_p->data == value;
+
+    if (curr_p != NULL)
+        pthread_mutex_unlock(curr_p->mutex);
+
+    return result;
+}
+
+// holds the predecessor (or the head mutex) and the current node while linking
+int insertFine (int value, struct thread_counter_s *counter)
+{
+    struct list_node_s* curr_p;
+    struct list_node_s* pred_p = NULL;
+    struct list_node_s* temp_p;
+    int result = 0;
+
+    lockHead(counter);
+    curr_p = head;
+    if (curr_p != NULL)
+        pthread_mutex_lock(curr_p->mutex);
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        if (pred_p == NULL)
+            pthread_mutex_unlock(&locks.headMutex);
+        else
+            pthread_mutex_unlock(pred_p->mutex);
+
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+        if (curr_p != NULL)
+            pthread_mutex_lock(curr_p->mutex);
+    }
+
+    if (curr_p == NULL || curr_p->data > value)
+    {
+        temp_p = newNode(value);
+        temp_p->mutex = newNodeLock();
+        temp_p->next = curr_p;
+
+        if (pred_p == NULL)
+            head = temp_p;
+        else
+            pred_p->next = temp_p;
+
+        result = 1;
+    }
+
+    if (curr_p != NULL)
+        pthread_mutex_unlock(curr_p->mutex);
+
+    if (pred_p == NULL)
+        pthread_mutex_unlock(&locks.headMutex);
+    else
+        pthread_mutex_unlock(pred_p->mutex);
+
+    return result;
+}
+
+int deleteFine (int value, struct thread_counter_s *counter)
+{
+    struct list_node_s* curr_p;
+    struct list_node_s* pred_p = NULL;
+    int result = 0;
+
+    lockHead(counter);
+    curr_p = head;
+    if (curr_p != NULL)
+        pthread_mutex_lock(curr_p->mutex);
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        if (pred_p == NULL)
+            pthread_mutex_unlock(&locks.headMutex);
+        else
+            pthread_mutex_unlock(pred_p->mutex);
+
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+        if (curr_p != NULL)
+            pthread_mutex_lock(curr_p->mutex);
+    }
+
+    if (curr_p != NULL && curr_p->data == value)
+    {
+        if (pred_p == NULL)
+            head = curr_p->next;
+        else
+            pred_p->next = curr_p->next;
+
+        // nobody else can reach the node once it is unlinked and unlocked
+        pthread_mutex_unlock(curr_p->mutex);
+        freeNode(curr_p);
+        curr_p = NULL;
+        result = 1;
+    }
+
+    if (curr_p != NULL)
+        pthread_mutex_unlock(curr_p->mutex);
+
+    if (pred_p == NULL)
+        pthread_mutex_unlock(&locks.headMutex);
+    else
+        pthread_mutex_unlock(pred_p->mutex);
+
+    return result;
+}
+
+struct list_node_s *newNode (int value)
+{
+    struct list_node_s *node = malloc(sizeof(struct list_node_s));
+
+    node->data = value;
+    node->next = NULL;
+    node->mutex = NULL;
+
+    return node;
+}
+
+pthread_mutex_t *newNodeLock ()
+{
+    pthread_mutex_t *mutex = malloc(sizeof(pthread_mutex_t));
+
+    pthread_mutex_init(mutex, NULL);
+    return mutex;
+}
+
+// every fine-grained operation enters through the head mutex, so that is
+// where its contention is counted
+void lockHead (struct thread_counter_s *counter)
+{
+    if (pthread_mutex_trylock(&locks.headMutex) != 0)
+    {
+        __atomic_store_n(&counter->contended, counter->contended + 1, __ATOMIC_RELAXED);
+        pthread_mutex_lock(&locks.headMutex);
+    }
+}
+
+void freeNode (struct list_node_s *node)
+{
+    if (node->mutex != NULL)
+    {
+        pthread_mutex_destroy(node->mutex);
+        free(node->mutex);
+    }
+    free(node);
+}
+
+// gives every node a mutex on entering the fine-grained scheme, called while
+// no worker is inside an operation
+void attachNodeLocks ()
+{
+    for (struct list_node_s *curr_p = head; curr_p != NULL; curr_p = curr_p->next)
+        curr_p->mutex = newNodeLock();
+}
+
+// frees the node mutexes on leaving the fine-grained scheme
+void detachNodeLocks ()
+{
+    for (struct list_node_s *curr_p = head; curr_p != NULL; curr_p = curr_p->next)
+    {
+        pthread_mutex_destroy(curr_p->mutex);
+        free(curr_p->mutex);
+        curr_p->mutex = NULL;
+    }
+}
+
+// runs one operation under the current scheme, counting the attempts that
+// found the lock busy
+void executeOperation (int operation, int value, struct thread_counter_s *counter)
+{
+    if (__atomic_load_n(&state.switchRequested, __ATOMIC_RELAXED))
+        parkWorker();
+
+    int mode = state.mode;
+
+    if (mode == MODE_MUTEX)
+    {
+        if (pthread_mutex_trylock(&locks.mutex) != 0)
+        {
+            __atomic_store_n(&counter->contended, counter->contended + 1, __ATOMIC_RELAXED);
+            pthread_mutex_lock(&locks.mutex);
+        }
+
+        if (operation == MEMBER)
+            member(value, head);
+        else if (operation == INSERT)
+            insert(value, &head);
+        else
+            delete(value, &head);
+
+        pthread_mutex_unlock(&locks.mutex);
+    }
+    else if (mode == MODE_RWLOCK)
+    {
+        if (operation == MEMBER && pthread_rwlock_tryrdlock(&locks.rwlock) != 0)
+        {
+            __atomic_store_n(&counter->contended, counter->contended + 1, __ATOMIC_RELAXED);
+            pthread_rwlock_rdlock(&locks.rwlock);
+        }
+        else if (operation != MEMBER && pthread_rwlock_trywrlock(&locks.rwlock) != 0)
+        {
+            __atomic_store_n(&counter->contended, counter->contended + 1, __ATOMIC_RELAXED);
+            pthread_rwlock_wrlock(&locks.rwlock);
+        }
+
+        if (operation == MEMBER)
+            member(value, head);
+        else if (operation == INSERT)
+            insert(value, &head);
+        else
+            delete(value, &head);
+
+        pthread_rwlock_unlock(&locks.rwlock);
+    }
+    else
+    {
+        if (operation == MEMBER)
+            memberFine(value, counter);
+        else if (operation == INSERT)
+            insertFine(value, counter);
+        else
+            deleteFine(value, counter);
+    }
+
+    if (operation == MEMBER)
+        __atomic_store_n(&counter->reads, counter->reads + 1, __ATOMIC_RELAXED);
+    else
+        __atomic_store_n(&counter->writes, counter->writes + 1, __ATOMIC_RELAXED);
+}
+
+// waits outside any operation until the monitor has changed the scheme
+void parkWorker ()
+{
+    pthread_mutex_lock(&state.mutex);
+
+    state.parkedCount++;
+    pthread_cond_signal(&state.parked);
+
+    while (state.switchRequested)
+        pthread_cond_wait(&state.resumed, &state.mutex);
+
+    state.parkedCount--;
+    pthread_mutex_unlock(&state.mutex);
+}
+
+// samples the per-thread statistics every interval until all workers are done;
+// contention proposes a switch, which is tried and judged by throughput
+void *monitorExecute ()
+{
+    struct timespec lastSample, now;
+    long lastReads = 0, lastWrites = 0, lastContended = 0;
+    int candidate = state.mode;
+    int candidateWindows = 0;
+    int dwellWindows = 0;
+    long windowIndex = 0;
+
+    // the windows of the current scheme since the proposal last changed, or
+    // since a tried scheme started
+    struct window_measure_s measure = { 0, 0, 0.0 };
+    int windowsInMode = 0;
+    double writeFraction = -1.0;    // smoothed over the windows, -1 before the first
+
+    // the scheme a running trial replaced and what it achieved, -1 outside a trial
+    int trialFrom = -1;
+    double baseThroughput = 0.0;
+    double baseWriteFraction = 0.0;
+
+    // backoff of rejected switches, indexed by [from][to]
+    long retryWindows[MODE_COUNT][MODE_COUNT] = { { 0 } };
+    long blockedUntil[MODE_COUNT][MODE_COUNT] = { { 0 } };
+    double blockedWriteFraction[MODE_COUNT][MODE_COUNT] = { { 0.0 } };
+
+    clock_gettime(CLOCK_MONOTONIC, &state.modeStart);
+    lastSample = state.modeStart;
+
+    while (__atomic_load_n(&state.finishedCount, __ATOMIC_RELAXED) < threadCount)
+    {
+        sleepSeconds(MONITOR_INTERVAL);
+
+        long reads = 0, writes = 0, contended = 0;
+        for (int i = 0; i < threadCount; i++)
+        {
+            reads += __atomic_load_n(&threadCounters[i].reads, __ATOMIC_RELAXED);
+            writes += __atomic_load_n(&threadCounters[i].writes, __ATOMIC_RELAXED);
+            contended += __atomic_load_n(&threadCounters[i].contended, __ATOMIC_RELAXED);
+        }
+
+        long windowReads = reads - lastReads;
+        long windowWrites = writes - lastWrites;
+
+        if (windowReads + windowWrites < MIN_WINDOW_OPERATIONS)
+            continue;   // too few operations in this window, keep counting
+
+        int proposal = proposeMode(state.mode, windowReads, windowWrites, contended - lastContended);
+        double windowWriteFraction = (double) windowWrites / (windowReads + windowWrites);
+
+        writeFraction = writeFraction < 0 ? windowWriteFraction
+            : MIX_SMOOTHING * windowWriteFraction + (1 - MIX_SMOOTHING) * writeFraction;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double seconds = elapsedSeconds(lastSample, now);
+        lastSample = now;
+        lastReads = reads;
+        lastWrites = writes;
+        lastContended = contended;
+        windowIndex++;
+
+        // the first window after a switch also holds the switch itself
+        if (windowsInMode++ > 0)
+        {
+            measure.operations += windowReads + windowWrites;
+            measure.writes += windowWrites;
+            measure.seconds += seconds;
+        }
+
+        // a tried scheme that is slower than the one it replaced on the same mix is
+        // undone, and the same switch waits twice as long as last time; on another
+        // mix the comparison says nothing and the trial is undone without a backoff
+        if (trialFrom >= 0 && windowsInMode > TRIAL_WINDOWS)
+        {
+            int from = trialFrom;
+            int to = state.mode;
+            double throughput = measure.operations / measure.seconds;
+            int sameMix = fabs((double) measure.writes / measure.operations - baseWriteFraction) <= MIX_CHANGE;
+
+            trialFrom = -1;
+
+            if (!sameMix || throughput < baseThroughput)
+            {
+                if (sameMix)
+                {
+                    retryWindows[from][to] = retryWindows[from][to] == 0 ? RETRY_WINDOWS
+                        : (retryWindows[from][to] * 2 < MAX_RETRY_WINDOWS ? retryWindows[from][to] * 2 : MAX_RETRY_WINDOWS);
+                    blockedUntil[from][to] = windowIndex + retryWindows[from][to];
+                    blockedWriteFraction[from][to] = baseWriteFraction;
+                    state.rejectedCount++;
+                }
+
+                switchMode(from);
+                candidate = from;
+                candidateWindows = 0;
+                dwellWindows = 0;
+                measure = (struct window_measure_s) { 0, 0, 0.0 };
+                windowsInMode = 0;
+                continue;
+            }
+        }
+
+        // a rejected switch is only proposed again after its backoff or on another
+        // mix; the backoff itself keeps growing with further rejections
+        if (proposal != state.mode && windowIndex < blockedUntil[state.mode][proposal])
+        {
+            if (fabs(writeFraction - blockedWriteFraction[state.mode][proposal]) <= MIX_CHANGE)
+                proposal = state.mode;
+            else
+                blockedUntil[state.mode][proposal] = 0;
+        }
+
+        // a proposal has to hold for several windows in a row before it is tried,
+        // and those windows are what the tried scheme has to beat
+        if (proposal != candidate)
+        {
+            candidate = proposal;
+            candidateWindows = 0;
+            if (trialFrom < 0)
+                measure = (struct window_measure_s) { 0, 0, 0.0 };
+        }
+
+        if (fixedMode || trialFrom >= 0 || ++dwellWindows < MIN_DWELL_WINDOWS
+            || candidate == state.mode || ++candidateWindows < STABLE_WINDOWS || measure.seconds <= 0)
+            continue;
+
+        trialFrom = state.mode;
+        baseThroughput = measure.operations / measure.seconds;
+        baseWriteFraction = (double) measure.writes / measure.operations;
+
+        switchMode(candidate);
+        dwellWindows = 0;
+        measure = (struct window_measure_s) { 0, 0, 0.0 };
+        windowsInMode = 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    state.modeTime[state.mode] += elapsedSeconds(state.modeStart, now);
+
+    return NULL;
+}
+
+// proposes a scheme for the observed window, from the signals that mean
+// something under the current one
+int proposeMode (int mode, long reads, long writes, long contended)
+{
+    long operations = reads + writes;
+    double contention = (double) contended / operations;
+    int readMostly = (double) writes / operations <= READ_MOSTLY;
+
+    if (mode == MODE_MUTEX)
+    {
+        if (contention < LOW_CONTENTION)
+            return MODE_MUTEX;
+
+        return readMostly ? MODE_RWLOCK : MODE_FINE;
+    }
+
+    // readers hardly ever fail tryrdlock, so only the mix tells when to leave
+    if (mode == MODE_RWLOCK)
+        return readMostly ? MODE_RWLOCK : MODE_MUTEX;
+
+    // the head mutex is held briefly, so a quiet one only proposes a trial of the mutex
+    if (readMostly)
+        return MODE_RWLOCK;
+
+    return contention < LOW_CONTENTION / 4 ? MODE_MUTEX : MODE_FINE;
+}
+
+// parks every running worker, changes the scheme and lets them continue
+void switchMode (int mode)
+{
+    struct timespec now;
+
+    pthread_mutex_lock(&state.mutex);
+
+    __atomic_store_n(&state.switchRequested, 1, __ATOMIC_RELAXED);
+    while (state.parkedCount + state.finishedCount < threadCount)
+        pthread_cond_wait(&state.parked, &state.mutex);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    state.modeTime[state.mode] += elapsedSeconds(state.modeStart, now);
+    state.modeStart = now;
+
+    if (mode == MODE_FINE)
+        attachNodeLocks();
+    else if (state.mode == MODE_FINE)
+        detachNodeLocks();
+
+    state.mode = mode;
+    state.switchCount++;
+
+    __atomic_store_n(&state.switchRequested, 0, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&state.resumed);
+    pthread_mutex_unlock(&state.mutex);
+}
+
+void getArgs (int argc, char *argv[])
+{
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "e:fp:")) != -1)
+    {
+        if (option == 'e' && strcmp(optarg, "mutex") == 0)
+            initialMode = MODE_MUTEX;
+        else if (option == 'e' && strcmp(optarg, "rwlock") == 0)
+            initialMode = MODE_RWLOCK;
+        else if (option == 'e' && strcmp(optarg, "fine") == 0)
+            initialMode = MODE_FINE;
+        else if (option == 'f')
+            fixedMode = 1;
+        else if (option == 'p' && phaseCount < MAX_PHASE_COUNT)
+            parsePhase(optarg);
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 6)
+    {
+        printf("Enter LinkedListAdaptive [-e mutex|rwlock|fine] [-f] [-p <mMember>,<mInsert>,<mDelete>]... <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+        exit(0);
+    }
+
+    argv += optind - 1;     // positional arguments follow the options
+
+    n = (int) strtol(argv[1], (char **) NULL, 10);
+    m = (int) strtol(argv[2], (char **) NULL, 10);
+    threadCount = (int) strtol(argv[3], (char **) NULL, 10);
+
+    mMemberFrac[0] = (float) atof(argv[4]);
+    mInsertFrac[0] = (float) atof(argv[5]);
+    mDeleteFrac[0] = (float) atof(argv[6]);
+
+    // validating thread count
+    if (threadCount <= 0 || threadCount > MAX_THREAD_COUNT)
+    {
+        printf ("Thread count is incorrect \n");
+        exit(0);
+    }
+
+    // arg validation
+    if (n <= 0 || m <= 0)
+    {
+        printf ("Please give the command with the arguments: ./LinkedListAdaptive <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+
+        if (n <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+
+        if (m <= 0)
+            printf ("Value you entered for m is incorrect! \n");
+
+        exit(0);
+    }
+
+    for (int i = 0; i < phaseCount; i++)
+    {
+        if (fabsf(mMemberFrac[i] + mInsertFrac[i] + mDeleteFrac[i] - 1.0f) > 1e-5)
+        {
+            printf ("mMember + mInsert + mDelete should equals to 1 in phase %d \n", i + 1);
+            exit(0);
+        }
+    }
+};
+
+// reads the fractions of one more phase from "<mMember>,<mInsert>,<mDelete>"
+void parsePhase (char *phase)
+{
+    if (sscanf(phase, "%f,%f,%f", &mMemberFrac[phaseCount], &mInsertFrac[phaseCount], &mDeleteFrac[phaseCount]) != 3)
+    {
+        printf ("Phase %s should be given as <mMember>,<mInsert>,<mDelete> \n", phase);
+        exit(0);
+    }
+
+    // phase 0 comes from the positional arguments, -p phases follow it
+    phaseCount++;
+}
+
+void* threadExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+
+    for (int phase = 0; phase < phaseCount; phase++)
+    {
+        // generate local no of operations without loss
+        int localMemberCount = generateLocalNumberOfOperations(mMemberFrac[phase] * m, threadCount, id);
+        int localInsertCount = generateLocalNumberOfOperations(mInsertFrac[phase] * m, threadCount, id);
+        int localDeleteCount = generateLocalNumberOfOperations(mDeleteFrac[phase] * m, threadCount, id);
+
+        int local_m = localMemberCount + localInsertCount + localDeleteCount;
+
+        int totalCount = 0;
+        int memberCount = 0;
+        int insertCount = 0;
+        int deleteCount = 0;
+
+        while(totalCount < local_m)
+        {
+            int randomValue = rand() % MAX_RANDOM_NUMBER;   //generate random number for operations
+            int randomOperation = rand() % 3;  //generate random operation type
+
+            if(randomOperation == MEMBER && memberCount < localMemberCount)
+            {
+                executeOperation(MEMBER, randomValue, counter);
+                memberCount++;
+            }
+            else if(randomOperation == INSERT && insertCount < localInsertCount)
+            {
+                executeOperation(INSERT, randomValue, counter);
+                insertCount++;
+            }
+            else if(randomOperation == DELETE && deleteCount < localDeleteCount)
+            {
+                executeOperation(DELETE, randomValue, counter);
+                deleteCount++;
+            }
+
+            totalCount = memberCount + insertCount + deleteCount;
+        }
+    }
+
+    // a finished worker counts as parked for every later switch
+    pthread_mutex_lock(&state.mutex);
+    __atomic_add_fetch(&state.finishedCount, 1, __ATOMIC_RELAXED);
+    pthread_cond_signal(&state.parked);
+    pthread_mutex_unlock(&state.mutex);
+
+    return NULL;
+}
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime)
+{
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void sleepSeconds (double seconds)
+{
+    struct timespec interval;
+    interval.tv_sec = (time_t) seconds;
+    interval.tv_nsec = (long) ((seconds - interval.tv_sec) * 1e9);
+
+    while (nanosleep(&interval, &interval) != 0)
+        ;
+}
+
+void deleteLinkedList (struct list_node_s** head_pp)
+{
+   struct list_node_s* current = *head_pp;
+   struct list_node_s* next;
+
+   while (current != NULL)
+   {
+       next = current->next;
+       freeNode(current);
+       current = next;
+   }
+
+   *head_pp = NULL;
+}
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id)
+{
+    int localOperationCount = 0;
+
+    if (noOfOperations % threadCount == 0|| noOfOperations % threadCount <= id)
+    {
+        localOperationCount = noOfOperations / threadCount;
+    }
+    else if (noOfOperations % threadCount > id)
+    {
+        localOperationCount = noOfOperations / threadCount + 1;
+    }
+
+    return localOperationCount;
+}
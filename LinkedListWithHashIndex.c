@@ -0,0 +1,948 @@
+/*
+* LinkedListWithHashIndex
+*
+* Same driver as LinkedListWithReadWriteLocks with a choice of engine:
+*
+*   list     - the sorted list under a read-write lock
+*   hash     - a lock-striped hash set: SEGMENT_COUNT segments, each an open
+*              addressing table with linear probing, tombstones and its own
+*              resize, guarded by its own mutex; no range queries
+*   combined - the sorted list for range queries plus the hash set as an
+*              index for member; writers update both under the write lock
+*
+* Comparing the engines on one workload gives the cost of keeping the order.
+*
+* Compile: gcc -g -Wall -o LinkedListWithHashIndex LinkedListWithHashIndex.c -lpthread -lm
+* Run : LinkedListWithHashIndex [-e list|hash|combined] [-d <duration> [-w <warmup>]] [-r <mRange> [-l <rangeLength>] [-c]]
+*       <n> <m> <threadCount> <mMember> <mIsert> <mDelete>
+*
+* With -d the threads run the operation mix for <duration> seconds instead of
+* splitting m operations, after an optional <warmup> excluded from measurement.
+*
+* With -r a fraction of the operations are range queries over <rangeLength>
+* consecutive keys, counting them or, with -c, collecting them in order.
+* These runs and duration mode also report the mean latency of each operation
+* type; plain runs do not time single operations, so their Mean/STD stays
+* comparable with the serial program.
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <math.h>
+#include <unistd.h>
+#include <string.h>
+
+#define MAX_RANDOM_NUMBER 65535
+#define MAX_THREAD_COUNT 1024
+#define CACHE_LINE_SIZE 64
+#define MEMBER 0
+#define INSERT 1
+#define DELETE 2
+#define RANGE 3
+#define OPERATION_TYPES 4
+#define ENGINE_LIST 0
+#define ENGINE_HASH 1
+#define ENGINE_COMBINED 2
+#define SEGMENT_COUNT 64            // power of two
+#define SEGMENT_BITS 6              // log2 of SEGMENT_COUNT
+#define INITIAL_SEGMENT_CAPACITY 16 // power of two
+#define EMPTY_SLOT -1
+#define TOMBSTONE_SLOT -2
+
+int n; // number of nodes in the linked list
+int m; // number of random operations in the linked list
+int threadCount = 0;
+int sampleSize = 65;    // number of samples considered
+
+// duration mode
+double duration = 0;    // seconds to run the mix for, 0 runs the fixed m operations
+double warmup = 0;      // seconds run before the measurement starts
+int stopFlag = 0;       // set by main once the duration has elapsed
+pthread_barrier_t startBarrier;
+int measuring = 1;      // latencies are only recorded while set, cleared during warm-up
+int recordLatencies = 0;    // time every operation, set with -r or -d
+
+// range queries
+int rangeLength = 100;  // number of consecutive keys covered by a range query
+int collectKeys = 0;    // range queries collect the keys instead of counting them
+
+// Fractions of each operations
+float mMemberFrac, mInsertFrac, mDeleteFrac;
+float mRangeFrac = 0;
+
+// operations count
+float mMember = 0;
+float mInsert = 0;
+float mDelete = 0;
+float mRange = 0;
+
+// latency of each operation type, summed over all samples
+double latencyTotal[OPERATION_TYPES];
+long latencyCount[OPERATION_TYPES];
+const char *operationNames[OPERATION_TYPES] = { "Member", "Insert", "Delete", "Range" };
+
+int engine = ENGINE_LIST;
+
+struct list_node_s *head = NULL;
+pthread_rwlock_t rwlock;
+
+// node definition
+struct list_node_s
+{
+    int data;
+    struct list_node_s *next;
+};
+
+// per-thread operation counter and latencies, padded to a full cache line
+struct thread_counter_s
+{
+    long operationCount;    // operations completed in duration mode
+    double latencyTotal[OPERATION_TYPES];
+    long latencyCount[OPERATION_TYPES];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// one stripe of the hash set, padded so that segments do not share cache lines
+struct hash_segment_s
+{
+    pthread_mutex_t mutex;
+    int *slots;         // keys, EMPTY_SLOT or TOMBSTONE_SLOT
+    int capacity;       // power of two
+    int used;           // live keys
+    int tombstones;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct thread_counter_s threadCounters[MAX_THREAD_COUNT];
+struct hash_segment_s segments[SEGMENT_COUNT];
+
+int member (int value, struct list_node_s* head_p);
+
+int insert (int value, struct list_node_s** head_pp);
+
+int delete (int value, struct list_node_s** head_pp);
+
+int countRange (int low, int high, struct list_node_s* head_p);
+
+int collectRange (int low, int high, int keys[], struct list_node_s* head_p);
+
+unsigned int hashValue (int value);
+
+int hashMember (int value);
+
+int hashInsert (int value);
+
+int hashDelete (int value);
+
+void resizeSegment (struct hash_segment_s *segment, int capacity);
+
+void initHashSet ();
+
+void deleteHashSet ();
+
+int populateInsert (int value);
+
+void getArgs (int argc, char *argv[]);
+
+void *threadExecute (void *id);
+
+void executeOperation (int operation, int value, struct thread_counter_s *counter, int rangeKeys[]);
+
+void aggregateLatencies (struct thread_counter_s *counter);
+
+void printLatencies ();
+
+void *durationExecute (void *id);
+
+void runDurationMode ();
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime);
+
+void sleepSeconds (double seconds);
+
+void deleteLinkedList (struct list_node_s** head_pp);
+
+float calculateSTD (double data[], float mean);
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id);
+ 
+int main (int argc, char *argv[])
+{
+    double timeArray[sampleSize];  // store total time taken for each sample
+    double totalTime = 0.0;
+    float mean= 0.0;
+    float std = 0.0;
+
+    getArgs(argc, argv);
+    mMember = mMemberFrac * m;
+    mInsert = mInsertFrac * m;
+    mDelete = mDeleteFrac * m;
+    mRange = mRangeFrac * m;
+
+    if (duration > 0)
+    {
+        runDurationMode();
+        return 0;
+    }
+
+    for (int j = 0; j < sampleSize; j++)
+    {
+        pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+        clock_t startTime, endTime;
+
+        int *threadID = (int *)malloc(sizeof(int) * threadCount);
+
+        // Linked list generation with non-repeating random numbers
+        initHashSet();
+        int i = 0;
+        for (; i < n; i++)
+        {
+            if (!populateInsert(rand() % MAX_RANDOM_NUMBER))
+                i--;
+        }
+
+        //initializing read-write lock
+        pthread_rwlock_init(&rwlock, NULL);
+
+        startTime = clock();
+
+        // thread creation
+        i = 0;
+        while (i < threadCount)
+        {
+            threadID[i] = i;
+            pthread_create(&threadHandler[i], NULL, (void *) threadExecute, (void *) &threadID[i]);
+            i++;
+        }
+
+        // thread join 
+        i = 0;
+        while (i < threadCount)
+        {
+            pthread_join(threadHandler[i], NULL);
+            aggregateLatencies(&threadCounters[i]);
+            i++;
+        }
+
+        endTime = clock();
+
+        // destroying the read-write lock
+        pthread_rwlock_destroy(&rwlock);
+
+        timeArray[j] = ((double) (endTime - startTime)) / CLOCKS_PER_SEC;
+        totalTime += timeArray[j];
+        deleteLinkedList(&head);
+        deleteHashSet();
+
+    }
+
+    mean = totalTime / sampleSize;  // mean time calculation
+    std = calculateSTD(timeArray, mean);    // std calculation
+
+    printf ("Mean : %f\n", mean);
+    printf ("STD : %f\n", std);
+    printLatencies();
+
+    return 0;
+    
+}
+
+int member (int value, struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+
+    while (curr_p != NULL && curr_p->data < value)
+        curr_p = curr_p->next; 
+    
+    if (curr_p == NULL || curr_p->data > value)
+    {
+        return 0;
+    }
+    else
+    {
+       return 1; 
+    }
+    
+};
+
+int insert (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+    struct list_node_s* temp_p;
+
+    while (curr_p != NULL && curr_p->data <value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p == NULL || curr_p->data >value)
+    {
+        temp_p = malloc(sizeof(struct list_node_s));
+        temp_p->data = value;
+        temp_p->next = curr_p;
+
+        if (pred_p == NULL)
+            *head_pp = temp_p;
+        else
+            pred_p->next = temp_p;
+        
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }    
+};
+
+int delete (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p != NULL && curr_p->data == value)
+    {
+        if (pred_p == NULL)
+        {
+            *head_pp = curr_p->next;
+            free(curr_p);
+        }
+        else
+        {
+            pred_p->next = curr_p->next;
+            free(curr_p);
+        }
+        return 1;   
+    }
+    else
+    {
+        return 0;
+    }  
+};
+
+// counts the keys in [low, high]; the caller holds the read lock for the
+// whole scan, so the count is a consistent snapshot of the list
+int countRange (int low, int high, struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+    int count = 0;
+
+    while (curr_p != NULL && curr_p->data < low)
+        curr_p = curr_p->next;
+
+    while (curr_p != NULL && curr_p->data <= high)
+    {
+        count++;
+        curr_p = curr_p->next;
+    }
+
+    return count;
+}
+
+// copies the keys in [low, high] into keys in ascending order and returns
+// how many were copied; keys must have room for high - low + 1 entries
+int collectRange (int low, int high, int keys[], struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+    int count = 0;
+
+    while (curr_p != NULL && curr_p->data < low)
+        curr_p = curr_p->next;
+
+    while (curr_p != NULL && curr_p->data <= high)
+    {
+        keys[count++] = curr_p->data;
+        curr_p = curr_p->next;
+    }
+
+    return count;
+}
+
+// multiplicative hash: the high bits pick the segment, the low bits the slot
+unsigned int hashValue (int value)
+{
+    return (unsigned int) value * 2654435761u;
+}
+
+int hashMember (int value)
+{
+    unsigned int hash = hashValue(value);
+    struct hash_segment_s *segment = &segments[hash >> (32 - SEGMENT_BITS)];
+    int result = 0;
+
+    pthread_mutex_lock(&segment->mutex);
+
+    int mask = segment->capacity - 1;
+    for (int slot = hash & mask; segment->slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+    {
+        if (segment->slots[slot] == value)
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&segment->mutex);
+    return result;
+}
+
+int hashInsert (int value)
+{
+    unsigned int hash = hashValue(value);
+    struct hash_segment_s *segment = &segments[hash >> (32 - SEGMENT_BITS)];
+    int result = 1;
+
+    pthread_mutex_lock(&segment->mutex);
+
+    // keep at most three quarters of the slots taken, tombstones included;
+    // the table only grows when live keys fill half of it
+    if ((segment->used + segment->tombstones + 1) * 4 > segment->capacity * 3)
+        resizeSegment(segment, segment->used * 2 >= segment->capacity ? segment->capacity * 2 : segment->capacity);
+
+    int mask = segment->capacity - 1;
+    int freeSlot = -1;
+    int slot = hash & mask;
+
+    for (; segment->slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+    {
+        if (segment->slots[slot] == value)
+        {
+            result = 0;
+            break;
+        }
+
+        if (segment->slots[slot] == TOMBSTONE_SLOT && freeSlot < 0)
+            freeSlot = slot;
+    }
+
+    if (result)
+    {
+        // the first tombstone on the probe path is reused
+        if (freeSlot >= 0)
+            segment->tombstones--;
+        else
+            freeSlot = slot;
+
+        segment->slots[freeSlot] = value;
+        segment->used++;
+    }
+
+    pthread_mutex_unlock(&segment->mutex);
+    return result;
+}
+
+int hashDelete (int value)
+{
+    unsigned int hash = hashValue(value);
+    struct hash_segment_s *segment = &segments[hash >> (32 - SEGMENT_BITS)];
+    int result = 0;
+
+    pthread_mutex_lock(&segment->mutex);
+
+    int mask = segment->capacity - 1;
+    for (int slot = hash & mask; segment->slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+    {
+        if (segment->slots[slot] == value)
+        {
+            // a tombstone keeps the probe paths through this slot intact
+            segment->slots[slot] = TOMBSTONE_SLOT;
+            segment->used--;
+            segment->tombstones++;
+            result = 1;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&segment->mutex);
+    return result;
+}
+
+// rehashes the live keys into a table of the given capacity, dropping the
+// tombstones; called with the segment mutex held
+void resizeSegment (struct hash_segment_s *segment, int capacity)
+{
+    int *oldSlots = segment->slots;
+    int oldCapacity = segment->capacity;
+
+    segment->slots = malloc(sizeof(int) * capacity);
+    segment->capacity = capacity;
+    segment->tombstones = 0;
+
+    for (int i = 0; i < capacity; i++)
+        segment->slots[i] = EMPTY_SLOT;
+
+    for (int i = 0; i < oldCapacity; i++)
+    {
+        if (oldSlots[i] < 0)
+            continue;
+
+        int slot = hashValue(oldSlots[i]) & (capacity - 1);
+        while (segment->slots[slot] != EMPTY_SLOT)
+            slot = (slot + 1) & (capacity - 1);
+
+        segment->slots[slot] = oldSlots[i];
+    }
+
+    free(oldSlots);
+}
+
+void initHashSet ()
+{
+    for (int i = 0; i < SEGMENT_COUNT; i++)
+    {
+        pthread_mutex_init(&segments[i].mutex, NULL);
+        segments[i].slots = malloc(sizeof(int) * INITIAL_SEGMENT_CAPACITY);
+        segments[i].capacity = INITIAL_SEGMENT_CAPACITY;
+        segments[i].used = 0;
+        segments[i].tombstones = 0;
+
+        for (int j = 0; j < INITIAL_SEGMENT_CAPACITY; j++)
+            segments[i].slots[j] = EMPTY_SLOT;
+    }
+}
+
+void deleteHashSet ()
+{
+    for (int i = 0; i < SEGMENT_COUNT; i++)
+    {
+        pthread_mutex_destroy(&segments[i].mutex);
+        free(segments[i].slots);
+        segments[i].slots = NULL;
+    }
+}
+
+// adds a key to every structure the engine keeps, used to generate the set
+int populateInsert (int value)
+{
+    if (engine == ENGINE_HASH)
+        return hashInsert(value);
+
+    if (!insert(value, &head))
+        return 0;
+
+    if (engine == ENGINE_COMBINED)
+        hashInsert(value);
+
+    return 1;
+}
+
+void getArgs (int argc, char *argv[])
+{
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "e:d:w:r:l:c")) != -1)
+    {
+        if (option == 'e' && strcmp(optarg, "list") == 0)
+            engine = ENGINE_LIST;
+        else if (option == 'e' && strcmp(optarg, "hash") == 0)
+            engine = ENGINE_HASH;
+        else if (option == 'e' && strcmp(optarg, "combined") == 0)
+            engine = ENGINE_COMBINED;
+        else if (option == 'd')
+            duration = atof(optarg);
+        else if (option == 'w')
+            warmup = atof(optarg);
+        else if (option == 'r')
+            mRangeFrac = (float) atof(optarg);
+        else if (option == 'l')
+            rangeLength = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 'c')
+            collectKeys = 1;
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 6)
+    {
+        printf("Enter LinkedListWithHashIndex [-e list|hash|combined] [-d <duration> [-w <warmup>]] [-r <mRange> [-l <rangeLength>] [-c]] <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+        exit(0);
+    }
+
+    argv += optind - 1;     // positional arguments follow the options
+
+    n = (int) strtol(argv[1], (char **) NULL, 10);
+    m = (int) strtol(argv[2], (char **) NULL, 10);
+    threadCount = (int) strtol(argv[3], (char **) NULL, 10);
+
+    mMemberFrac = (float) atof(argv[4]);
+    mInsertFrac = (float) atof(argv[5]);
+    mDeleteFrac = (float) atof(argv[6]);
+
+    // validating thread count
+    if (threadCount <= 0 || threadCount > MAX_THREAD_COUNT)
+    {
+        printf ("Thread count is incorrect \n");
+        exit(0);
+    }
+
+    recordLatencies = mRangeFrac > 0 || duration > 0;
+
+    // validating duration mode
+    if (duration < 0 || warmup < 0 || (warmup > 0 && duration == 0))
+    {
+        printf ("Duration and warm-up should be positive, and warm-up needs a duration \n");
+        exit(0);
+    }
+
+    // validating range queries
+    if (mRangeFrac < 0 || rangeLength <= 0)
+    {
+        printf ("Range fraction and range length should be positive \n");
+        exit(0);
+    }
+
+    if (engine == ENGINE_HASH && mRangeFrac > 0)
+    {
+        printf ("The hash engine keeps no order, use the list or combined engine for range queries \n");
+        exit(0);
+    }
+
+    // arg validation
+    if (n <= 0 || m <= 0 || fabsf(mMemberFrac + mInsertFrac + mDeleteFrac + mRangeFrac - 1.0f) > 1e-5)
+    {
+        printf ("Please give the command with the arguments: ./serial_linked list <n> <m> <mMember> <mInsert> <mDelete> \n");
+
+        if (n <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+        
+        if (m <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+
+        if (fabsf(mMemberFrac + mInsertFrac + mDeleteFrac + mRangeFrac - 1.0f) > 1e-5)
+            printf ("mMember + mInsert + mDelete + mRange should equals to 1 \n");
+        
+        exit(0);
+    }
+};
+
+void* threadExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+    int *rangeKeys = (int *)malloc(sizeof(int) * rangeLength);
+
+    // generate local no of member operationswithout loss
+    int localMemberCount = generateLocalNumberOfOperations(mMember, threadCount, id);
+    int localInsertCount = generateLocalNumberOfOperations(mInsert, threadCount, id);
+    int localDeleteCount = generateLocalNumberOfOperations(mDelete, threadCount, id);
+    int localRangeCount = generateLocalNumberOfOperations(mRange, threadCount, id);
+
+    int local_m = localMemberCount + localInsertCount + localDeleteCount + localRangeCount;
+    int operationTypes = mRangeFrac > 0 ? OPERATION_TYPES : 3;
+
+    *counter = (struct thread_counter_s) { 0 };
+
+    int totalCount = 0;
+    int memberCount = 0;
+    int insertCount = 0;
+    int deleteCount = 0;
+    int rangeCount = 0;
+
+    int i = 0;
+    while(totalCount < local_m)
+    {
+        int randomValue = rand() % MAX_RANDOM_NUMBER;   //generate random number for operations
+        int randomOperation = rand() % operationTypes;  //generate random operation type
+
+        if(randomOperation == MEMBER)
+        {
+            if (memberCount < localMemberCount)
+            {
+                executeOperation(MEMBER, randomValue, counter, rangeKeys);
+                memberCount++;
+            }
+        }
+        else if(randomOperation == INSERT)
+        {
+            if (insertCount < localInsertCount)
+            {
+                executeOperation(INSERT, randomValue, counter, rangeKeys);
+                insertCount++;
+            }
+        }
+        else if(randomOperation == DELETE)
+        {
+            if (deleteCount < localDeleteCount)
+            {
+                executeOperation(DELETE, randomValue, counter, rangeKeys);
+                deleteCount++;
+            }
+        }
+        else if(randomOperation == RANGE)
+        {
+            if (rangeCount < localRangeCount)
+            {
+                executeOperation(RANGE, randomValue, counter, rangeKeys);
+                rangeCount++;
+            }
+        }
+
+        totalCount = memberCount + insertCount + deleteCount + rangeCount;
+        i++;
+    }
+
+    free(rangeKeys);
+    return NULL;
+}
+
+// runs one operation on the selected engine and records its latency
+void executeOperation (int operation, int value, struct thread_counter_s *counter, int rangeKeys[])
+{
+    struct timespec startTime, endTime;
+
+    if (recordLatencies)
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    if (engine == ENGINE_HASH)
+    {
+        if (operation == MEMBER)
+            hashMember(value);
+        else if (operation == INSERT)
+            hashInsert(value);
+        else
+            hashDelete(value);
+    }
+    else if (engine == ENGINE_COMBINED && operation == MEMBER)
+    {
+        // point lookups go to the index only
+        hashMember(value);
+    }
+    else
+    {
+        if (operation == INSERT || operation == DELETE)
+            pthread_rwlock_wrlock(&rwlock);
+        else
+            pthread_rwlock_rdlock(&rwlock);
+
+        if (operation == MEMBER)
+            member(value, head);
+        else if (operation == INSERT)
+        {
+            if (insert(value, &head) && engine == ENGINE_COMBINED)
+                hashInsert(value);
+        }
+        else if (operation == DELETE)
+        {
+            if (delete(value, &head) && engine == ENGINE_COMBINED)
+                hashDelete(value);
+        }
+        else if (collectKeys)
+            collectRange(value, value + rangeLength - 1, rangeKeys, head);
+        else
+            countRange(value, value + rangeLength - 1, head);
+        pthread_rwlock_unlock(&rwlock);
+    }
+
+    if (recordLatencies)
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    if (recordLatencies && __atomic_load_n(&measuring, __ATOMIC_RELAXED))
+    {
+        counter->latencyTotal[operation] += elapsedSeconds(startTime, endTime);
+        counter->latencyCount[operation]++;
+    }
+}
+
+void aggregateLatencies (struct thread_counter_s *counter)
+{
+    for (int i = 0; i < OPERATION_TYPES; i++)
+    {
+        latencyTotal[i] += counter->latencyTotal[i];
+        latencyCount[i] += counter->latencyCount[i];
+    }
+}
+
+// prints the mean latency in microseconds of every operation type that ran
+void printLatencies ()
+{
+    for (int i = 0; i < OPERATION_TYPES; i++)
+    {
+        if (latencyCount[i] > 0)
+            printf ("%s Latency (us) : %f\n", operationNames[i], latencyTotal[i] / latencyCount[i] * 1e6);
+    }
+}
+
+float calculateSTD (double data[], float mean)
+{
+    float standardDeviation = 0.0; 
+
+    for (int i = 0; i < sampleSize; ++i)
+        standardDeviation += pow(data[i] - mean, 2);
+
+    return sqrt(standardDeviation / sampleSize);
+}
+
+void deleteLinkedList (struct list_node_s** head_pp)
+{ 
+   struct list_node_s* current = *head_pp; 
+   struct list_node_s* next; 
+  
+   while (current != NULL)  
+   { 
+       next = current->next; 
+       free(current); 
+       current = next; 
+   } 
+   
+   *head_pp = NULL; 
+}
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id)
+{
+    int localOperationCount = 0;
+
+    if (noOfOperations % threadCount == 0|| noOfOperations % threadCount <= id)
+    {
+        localOperationCount = noOfOperations / threadCount;
+    }
+    else if (noOfOperations % threadCount > id)
+    {
+        localOperationCount = noOfOperations / threadCount + 1;
+    }
+
+    return localOperationCount;
+}
+
+// runs the operation mix on all threads for the given duration and reports
+// the throughput of every thread along with the fairness between them
+void runDurationMode ()
+{
+    pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+    int *threadID = (int *)malloc(sizeof(int) * threadCount);
+    long *warmupCount = (long *)malloc(sizeof(long) * threadCount);
+    long *threadOperations = (long *)malloc(sizeof(long) * threadCount);
+    struct timespec startTime, endTime;
+
+    // Linked list generation with non-repeat random numbers
+    initHashSet();
+    for (int i =0; i < n; i++)
+    {
+        if (!populateInsert(rand() % MAX_RANDOM_NUMBER))
+            i--;
+    }
+
+    pthread_rwlock_init(&rwlock, NULL);
+    pthread_barrier_init(&startBarrier, NULL, threadCount + 1);
+    stopFlag = 0;
+    measuring = warmup == 0;
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        threadID[k] = k;
+        threadCounters[k] = (struct thread_counter_s) { 0 };
+        pthread_create (&threadHandler[k], NULL, (void *) durationExecute, (void *) &threadID[k]);
+    }
+
+    // all threads start together, the warm-up operations are subtracted later
+    pthread_barrier_wait(&startBarrier);
+    sleepSeconds(warmup);
+
+    __atomic_store_n(&measuring, 1, __ATOMIC_RELAXED);
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    for (int k = 0; k < threadCount; k++)
+        warmupCount[k] = __atomic_load_n(&threadCounters[k].operationCount, __ATOMIC_RELAXED);
+
+    sleepSeconds(duration);
+
+    for (int k = 0; k < threadCount; k++)
+        threadOperations[k] = __atomic_load_n(&threadCounters[k].operationCount, __ATOMIC_RELAXED) - warmupCount[k];
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    __atomic_store_n(&stopFlag, 1, __ATOMIC_RELAXED);
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        pthread_join (threadHandler[k], NULL);
+        aggregateLatencies(&threadCounters[k]);
+    }
+
+    pthread_barrier_destroy(&startBarrier);
+    pthread_rwlock_destroy(&rwlock);
+    deleteLinkedList(&head);
+    deleteHashSet();
+
+    double measuredTime = elapsedSeconds(startTime, endTime);
+    long totalOperations = 0;
+    long minOperations = threadOperations[0];
+    long maxOperations = threadOperations[0];
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        totalOperations += threadOperations[k];
+        if (threadOperations[k] < minOperations)
+            minOperations = threadOperations[k];
+        if (threadOperations[k] > maxOperations)
+            maxOperations = threadOperations[k];
+    }
+
+    printf ("Duration : %f\n", measuredTime);
+    printf ("Total Throughput : %f\n", totalOperations / measuredTime);
+
+    for (int k = 0; k < threadCount; k++)
+        printf ("Thread %d Throughput : %f\n", k, threadOperations[k] / measuredTime);
+
+    // share of the total operations done by the slowest and the fastest thread
+    printf ("Min Thread Share : %f\n", totalOperations > 0 ? (double) minOperations / totalOperations : 0.0);
+    printf ("Max Thread Share : %f\n", totalOperations > 0 ? (double) maxOperations / totalOperations : 0.0);
+    printf ("Fairness : %f\n", maxOperations > 0 ? (double) minOperations / maxOperations : 0.0);
+    printLatencies();
+
+    free(threadHandler);
+    free(threadID);
+    free(warmupCount);
+    free(threadOperations);
+}
+
+void* durationExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+    unsigned int seed = (unsigned int) time(NULL) + id;    // rand() serializes threads on its internal lock
+
+    int *rangeKeys = (int *)malloc(sizeof(int) * rangeLength);
+
+    pthread_barrier_wait(&startBarrier);
+
+    while (!__atomic_load_n(&stopFlag, __ATOMIC_RELAXED))
+    {
+        int randomValue = rand_r(&seed) % MAX_RANDOM_NUMBER;   //generate random number for operations
+        float randomFraction = (float) rand_r(&seed) / ((float) RAND_MAX + 1);   //pick the operation by its fraction
+
+        if (randomFraction < mMemberFrac)
+            executeOperation(MEMBER, randomValue, counter, rangeKeys);
+        else if (randomFraction < mMemberFrac + mInsertFrac)
+            executeOperation(INSERT, randomValue, counter, rangeKeys);
+        else if (mRangeFrac == 0 || randomFraction < mMemberFrac + mInsertFrac + mDeleteFrac)
+            executeOperation(DELETE, randomValue, counter, rangeKeys);
+        else
+            executeOperation(RANGE, randomValue, counter, rangeKeys);
+
+        __atomic_store_n(&counter->operationCount, counter->operationCount + 1, __ATOMIC_RELAXED);
+    }
+
+    free(rangeKeys);
+    return NULL;
+}
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime)
+{
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void sleepSeconds (double seconds)
+{
+    struct timespec interval;
+    interval.tv_sec = (time_t) seconds;
+    interval.tv_nsec = (long) ((seconds - interval.tv_sec) * 1e9);
+
+    while (nanosleep(&interval, &interval) != 0)
+        ;
+}
@@ -2,7 +2,22 @@
 * LinkedListWithReadWriteLocks
 *
 * Compile: gcc -g -Wall -o LinkedListWithReadWriteLocks LinkedListWithReadWriteLocks.c
-* Run : LinkedListWithReadWriteLocks <n> <m> <threadCount> <mMember> <mIsert> <mDelete>
+* Run : LinkedListWithReadWriteLocks [-d <duration> [-w <warmup>]] [-r <mRange> [-l <rangeLength>] [-c]] [-p]
+*       <n> <m> <threadCount> <mMember> <mIsert> <mDelete>
+*
+* With -d the threads run the operation mix for <duration> seconds instead of
+* splitting m operations, after an optional <warmup> excluded from measurement.
+*
+* With -r a fraction of the operations are range queries over <rangeLength>
+* consecutive keys, counting them or, with -c, collecting them in order.
+* These runs and duration mode also report the mean latency of each operation
+* type; plain runs do not time single operations, so their Mean/STD stays
+* comparable with the serial program.
+*
+* With -p the hardware events of all threads of each sample are counted (see
+* perfCounters.h); the counters are opened before the timer starts and closed
+* after it stops, so they do not add to the Mean. The sums are reported per
+* operation.
 *
 */
 
@@ -11,28 +26,51 @@
 #include <time.h>
 #include <pthread.h>
 #include <math.h>
+#include <unistd.h>
+#include "perfCounters.h"
 
 #define MAX_RANDOM_NUMBER 65535
 #define MAX_THREAD_COUNT 1024
+#define CACHE_LINE_SIZE 64
 #define MEMBER 0
 #define INSERT 1
 #define DELETE 2
+#define RANGE 3
+#define OPERATION_TYPES 4
 
 int n; // number of nodes in the linked list
 int m; // number of random operations in the linked list
 int threadCount = 0;
 int sampleSize = 65;    // number of samples considered
 
+// duration mode
+double duration = 0;    // seconds to run the mix for, 0 runs the fixed m operations
+double warmup = 0;      // seconds run before the measurement starts
+int stopFlag = 0;       // set by main once the duration has elapsed
+pthread_barrier_t startBarrier;
+int measuring = 1;      // latencies are only recorded while set, cleared during warm-up
+int recordLatencies = 0;    // time every operation, set with -r or -d
+
+// range queries
+int rangeLength = 100;  // number of consecutive keys covered by a range query
+int collectKeys = 0;    // range queries collect the keys instead of counting them
+
+int collectPerfCounters = 0;    // count hardware events of the threads of each sample
+
 // Fractions of each operations
 float mMemberFrac, mInsertFrac, mDeleteFrac;
+float mRangeFrac = 0;
 
 // operations count
 float mMember = 0;
 float mInsert = 0;
 float mDelete = 0;
+float mRange = 0;
 
-struct list_node_s *head = NULL;
-pthread_rwlock_t rwlock;
+// latency of each operation type, summed over all samples
+double latencyTotal[OPERATION_TYPES];
+long latencyCount[OPERATION_TYPES];
+const char *operationNames[OPERATION_TYPES] = { "Member", "Insert", "Delete", "Range" };
 
 // node definition
 struct list_node_s
@@ -41,16 +79,59 @@ struct list_node_s
     struct list_node_s *next;
 };
 
+// per-thread operation counter and latencies, padded to a full cache line so
+// that threads recording their own operations do not invalidate each other
+struct thread_counter_s
+{
+    long operationCount;    // operations completed in duration mode
+    double latencyTotal[OPERATION_TYPES];
+    long latencyCount[OPERATION_TYPES];
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// the read-write lock and the list head each get a cache line of their own
+struct padded_rwlock_s
+{
+    pthread_rwlock_t rwlock;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct padded_head_s
+{
+    struct list_node_s *head;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct padded_rwlock_s sharedRwlock;
+struct padded_head_s sharedHead = { NULL };
+struct thread_counter_s threadCounters[MAX_THREAD_COUNT];
+struct perf_counters_s perfTotal;    // summed over threads and samples
+
 int member (int value, struct list_node_s* head_p);
 
 int insert (int value, struct list_node_s** head_pp);
 
 int delete (int value, struct list_node_s** head_pp);
 
+int countRange (int low, int high, struct list_node_s* head_p);
+
+int collectRange (int low, int high, int keys[], struct list_node_s* head_p);
+
 void getArgs (int argc, char *argv[]);
 
 void *threadExecute (void *id);
 
+void executeOperation (int operation, int value, struct thread_counter_s *counter, int rangeKeys[]);
+
+void aggregateLatencies (struct thread_counter_s *counter);
+
+void printLatencies ();
+
+void *durationExecute (void *id);
+
+void runDurationMode ();
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime);
+
+void sleepSeconds (double seconds);
+
 void deleteLinkedList (struct list_node_s** head_pp);
 
 float calculateSTD (double data[], float mean);
@@ -68,6 +149,13 @@ int main (int argc, char *argv[])
     mMember = mMemberFrac * m;
     mInsert = mInsertFrac * m;
     mDelete = mDeleteFrac * m;
+    mRange = mRangeFrac * m;
+
+    if (duration > 0)
+    {
+        runDurationMode();
+        return 0;
+    }
 
     for (int j = 0; j < sampleSize; j++)
     {
@@ -80,12 +168,16 @@ int main (int argc, char *argv[])
         int i = 0;
         for (; i < n; i++)
         {
-            if (!insert(rand() % MAX_RANDOM_NUMBER, &head))
+            if (!insert(rand() % MAX_RANDOM_NUMBER, &sharedHead.head))
                 i--;
         }
 
         //initializing read-write lock
-        pthread_rwlock_init(&rwlock, NULL);
+        pthread_rwlock_init(&sharedRwlock.rwlock, NULL);
+
+        // the counters follow every thread created below
+        if (collectPerfCounters)
+            startPerfCounters(&perfTotal);
 
         startTime = clock();
 
@@ -103,17 +195,21 @@ int main (int argc, char *argv[])
         while (i < threadCount)
         {
             pthread_join(threadHandler[i], NULL);
+            aggregateLatencies(&threadCounters[i]);
             i++;
         }
 
         endTime = clock();
 
+        if (collectPerfCounters)
+            stopPerfCounters(&perfTotal);
+
         // destroying the read-write lock
-        pthread_rwlock_destroy(&rwlock);
+        pthread_rwlock_destroy(&sharedRwlock.rwlock);
 
         timeArray[j] = ((double) (endTime - startTime)) / CLOCKS_PER_SEC;
         totalTime += timeArray[j];
-        deleteLinkedList(&head);
+        deleteLinkedList(&sharedHead.head);
 
     }
 
@@ -122,6 +218,10 @@ int main (int argc, char *argv[])
 
     printf ("Mean : %f\n", mean);
     printf ("STD : %f\n", std);
+    printLatencies();
+
+    if (collectPerfCounters)
+        printPerfCounters(&perfTotal, (double) m * sampleSize);
 
     return 0;
     
@@ -207,14 +307,74 @@ int delete (int value, struct list_node_s** head_pp)
     }  
 };
 
+// counts the keys in [low, high]; the caller holds the read lock for the
+// whole scan, so the count is a consistent snapshot of the list
+int countRange (int low, int high, struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+    int count = 0;
+
+    while (curr_p != NULL && curr_p->data < low)
+        curr_p = curr_p->next;
+
+    while (curr_p != NULL && curr_p->data <= high)
+    {
+        count++;
+        curr_p = curr_p->next;
+    }
+
+    return count;
+}
+
+// copies the keys in [low, high] into keys in ascending order and returns
+// how many were copied; keys must have room for high - low + 1 entries
+int collectRange (int low, int high, int keys[], struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+    int count = 0;
+
+    while (curr_p != NULL && curr_p->data < low)
+        curr_p = curr_p->next;
+
+    while (curr_p != NULL && curr_p->data <= high)
+    {
+        keys[count++] = curr_p->data;
+        curr_p = curr_p->next;
+    }
+
+    return count;
+}
+
 void getArgs (int argc, char *argv[])
 {
-    if(argc != 7)
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "d:w:r:l:cp")) != -1)
+    {
+        if (option == 'd')
+            duration = atof(optarg);
+        else if (option == 'w')
+            warmup = atof(optarg);
+        else if (option == 'r')
+            mRangeFrac = (float) atof(optarg);
+        else if (option == 'l')
+            rangeLength = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 'c')
+            collectKeys = 1;
+        else if (option == 'p')
+            collectPerfCounters = 1;
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 6)
     {
-        printf("Enter LinkedListWithReadWriteLocks <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+        printf("Enter LinkedListWithReadWriteLocks [-d <duration> [-w <warmup>]] [-r <mRange> [-l <rangeLength>] [-c]] [-p] <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
         exit(0);
     }
 
+    argv += optind - 1;     // positional arguments follow the options
+
     n = (int) strtol(argv[1], (char **) NULL, 10);
     m = (int) strtol(argv[2], (char **) NULL, 10);
     threadCount = (int) strtol(argv[3], (char **) NULL, 10);
@@ -230,8 +390,30 @@ void getArgs (int argc, char *argv[])
         exit(0);
     }
 
+    recordLatencies = mRangeFrac > 0 || duration > 0;
+
+    // validating duration mode
+    if (duration < 0 || warmup < 0 || (warmup > 0 && duration == 0))
+    {
+        printf ("Duration and warm-up should be positive, and warm-up needs a duration \n");
+        exit(0);
+    }
+
+    if (collectPerfCounters && duration > 0)
+    {
+        printf ("Hardware counters are only collected per sample, not in duration mode \n");
+        exit(0);
+    }
+
+    // validating range queries
+    if (mRangeFrac < 0 || rangeLength <= 0)
+    {
+        printf ("Range fraction and range length should be positive \n");
+        exit(0);
+    }
+
     // arg validation
-    if (n <= 0 || m <= 0 || mMemberFrac + mInsertFrac + mDeleteFrac != 1.0)
+    if (n <= 0 || m <= 0 || fabsf(mMemberFrac + mInsertFrac + mDeleteFrac + mRangeFrac - 1.0f) > 1e-5)
     {
         printf ("Please give the command with the arguments: ./serial_linked list <n> <m> <mMember> <mInsert> <mDelete> \n");
 
@@ -241,8 +423,8 @@ void getArgs (int argc, char *argv[])
         if (m <= 0)
             printf ("Value you entered for n is incorrect! \n");
 
-        if (mMemberFrac + mInsertFrac + mDeleteFrac != 1.0)
-            printf ("mMember + mInsert + mDelete should equals to 1 \n");
+        if (fabsf(mMemberFrac + mInsertFrac + mDeleteFrac + mRangeFrac - 1.0f) > 1e-5)
+            printf ("mMember + mInsert + mDelete + mRange should equals to 1 \n");
         
         exit(0);
     }
@@ -251,62 +433,127 @@ void getArgs (int argc, char *argv[])
 void* threadExecute(void* thread_id)
 {
     int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+    int *rangeKeys = (int *)malloc(sizeof(int) * rangeLength);
 
     // generate local no of member operationswithout loss
     int localMemberCount = generateLocalNumberOfOperations(mMember, threadCount, id);
     int localInsertCount = generateLocalNumberOfOperations(mInsert, threadCount, id);
     int localDeleteCount = generateLocalNumberOfOperations(mDelete, threadCount, id);
+    int localRangeCount = generateLocalNumberOfOperations(mRange, threadCount, id);
+
+    int local_m = localMemberCount + localInsertCount + localDeleteCount + localRangeCount;
+    int operationTypes = mRangeFrac > 0 ? OPERATION_TYPES : 3;
 
-    int local_m = localMemberCount + localInsertCount + localDeleteCount;
+    *counter = (struct thread_counter_s) { 0 };
 
     int totalCount = 0;
     int memberCount = 0;
     int insertCount = 0;
     int deleteCount = 0;
+    int rangeCount = 0;
 
     int i = 0;
     while(totalCount < local_m)
     {
         int randomValue = rand() % MAX_RANDOM_NUMBER;   //generate random number for operations
-        int randomOperation = rand() % 3;  //generate random operation type
+        int randomOperation = rand() % operationTypes;  //generate random operation type
 
         if(randomOperation == MEMBER)
         {
             if (memberCount < localMemberCount)
             {
-                pthread_rwlock_rdlock(&rwlock);
-                member(randomValue, head);
+                executeOperation(MEMBER, randomValue, counter, rangeKeys);
                 memberCount++;
-                pthread_rwlock_unlock(&rwlock);
-            }   
+            }
         }
         else if(randomOperation == INSERT)
         {
             if (insertCount < localInsertCount)
             {
-                pthread_rwlock_rdlock(&rwlock);
-                insert(randomValue, &head);
+                executeOperation(INSERT, randomValue, counter, rangeKeys);
                 insertCount++;
-                pthread_rwlock_unlock(&rwlock);
-            }    
+            }
         }
         else if(randomOperation == DELETE)
         {
             if (deleteCount < localDeleteCount)
             {
-                pthread_rwlock_rdlock(&rwlock);
-                delete(randomValue, &head);
+                executeOperation(DELETE, randomValue, counter, rangeKeys);
                 deleteCount++;
-                pthread_rwlock_unlock(&rwlock);
+            }
+        }
+        else if(randomOperation == RANGE)
+        {
+            if (rangeCount < localRangeCount)
+            {
+                executeOperation(RANGE, randomValue, counter, rangeKeys);
+                rangeCount++;
             }
         }
 
-        totalCount = memberCount + insertCount + deleteCount;
+        totalCount = memberCount + insertCount + deleteCount + rangeCount;
         i++;
     }
+
+    free(rangeKeys);
     return NULL;
 }
 
+// runs one operation under the read-write lock and records its latency
+void executeOperation (int operation, int value, struct thread_counter_s *counter, int rangeKeys[])
+{
+    struct timespec startTime, endTime;
+
+    if (recordLatencies)
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    if (operation == INSERT || operation == DELETE)
+        pthread_rwlock_wrlock(&sharedRwlock.rwlock);
+    else
+        pthread_rwlock_rdlock(&sharedRwlock.rwlock);
+
+    if (operation == MEMBER)
+        member(value, sharedHead.head);
+    else if (operation == INSERT)
+        insert(value, &sharedHead.head);
+    else if (operation == DELETE)
+        delete(value, &sharedHead.head);
+    else if (collectKeys)
+        collectRange(value, value + rangeLength - 1, rangeKeys, sharedHead.head);
+    else
+        countRange(value, value + rangeLength - 1, sharedHead.head);
+    pthread_rwlock_unlock(&sharedRwlock.rwlock);
+
+    if (recordLatencies)
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    if (recordLatencies && __atomic_load_n(&measuring, __ATOMIC_RELAXED))
+    {
+        counter->latencyTotal[operation] += elapsedSeconds(startTime, endTime);
+        counter->latencyCount[operation]++;
+    }
+}
+
+void aggregateLatencies (struct thread_counter_s *counter)
+{
+    for (int i = 0; i < OPERATION_TYPES; i++)
+    {
+        latencyTotal[i] += counter->latencyTotal[i];
+        latencyCount[i] += counter->latencyCount[i];
+    }
+}
+
+// prints the mean latency in microseconds of every operation type that ran
+void printLatencies ()
+{
+    for (int i = 0; i < OPERATION_TYPES; i++)
+    {
+        if (latencyCount[i] > 0)
+            printf ("%s Latency (us) : %f\n", operationNames[i], latencyTotal[i] / latencyCount[i] * 1e6);
+    }
+}
+
 float calculateSTD (double data[], float mean)
 {
     float standardDeviation = 0.0; 
@@ -347,3 +594,137 @@ int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id
 
     return localOperationCount;
 }
+
+// runs the operation mix on all threads for the given duration and reports
+// the throughput of every thread along with the fairness between them
+void runDurationMode ()
+{
+    pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+    int *threadID = (int *)malloc(sizeof(int) * threadCount);
+    long *warmupCount = (long *)malloc(sizeof(long) * threadCount);
+    long *threadOperations = (long *)malloc(sizeof(long) * threadCount);
+    struct timespec startTime, endTime;
+
+    // Linked list generation with non-repeat random numbers
+    for (int i =0; i < n; i++)
+    {
+        if (!insert(rand() % MAX_RANDOM_NUMBER, &sharedHead.head))
+            i--;
+    }
+
+    pthread_rwlock_init(&sharedRwlock.rwlock, NULL);
+    pthread_barrier_init(&startBarrier, NULL, threadCount + 1);
+    stopFlag = 0;
+    measuring = warmup == 0;
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        threadID[k] = k;
+        threadCounters[k] = (struct thread_counter_s) { 0 };
+        pthread_create (&threadHandler[k], NULL, (void *) durationExecute, (void *) &threadID[k]);
+    }
+
+    // all threads start together, the warm-up operations are subtracted later
+    pthread_barrier_wait(&startBarrier);
+    sleepSeconds(warmup);
+
+    __atomic_store_n(&measuring, 1, __ATOMIC_RELAXED);
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    for (int k = 0; k < threadCount; k++)
+        warmupCount[k] = __atomic_load_n(&threadCounters[k].operationCount, __ATOMIC_RELAXED);
+
+    sleepSeconds(duration);
+
+    for (int k = 0; k < threadCount; k++)
+        threadOperations[k] = __atomic_load_n(&threadCounters[k].operationCount, __ATOMIC_RELAXED) - warmupCount[k];
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    __atomic_store_n(&stopFlag, 1, __ATOMIC_RELAXED);
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        pthread_join (threadHandler[k], NULL);
+        aggregateLatencies(&threadCounters[k]);
+    }
+
+    pthread_barrier_destroy(&startBarrier);
+    pthread_rwlock_destroy(&sharedRwlock.rwlock);
+    deleteLinkedList(&sharedHead.head);
+
+    double measuredTime = elapsedSeconds(startTime, endTime);
+    long totalOperations = 0;
+    long minOperations = threadOperations[0];
+    long maxOperations = threadOperations[0];
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        totalOperations += threadOperations[k];
+        if (threadOperations[k] < minOperations)
+            minOperations = threadOperations[k];
+        if (threadOperations[k] > maxOperations)
+            maxOperations = threadOperations[k];
+    }
+
+    printf ("Duration : %f\n", measuredTime);
+    printf ("Total Throughput : %f\n", totalOperations / measuredTime);
+
+    for (int k = 0; k < threadCount; k++)
+        printf ("Thread %d Throughput : %f\n", k, threadOperations[k] / measuredTime);
+
+    // share of the total operations done by the slowest and the fastest thread
+    printf ("Min Thread Share : %f\n", totalOperations > 0 ? (double) minOperations / totalOperations : 0.0);
+    printf ("Max Thread Share : %f\n", totalOperations > 0 ? (double) maxOperations / totalOperations : 0.0);
+    printf ("Fairness : %f\n", maxOperations > 0 ? (double) minOperations / maxOperations : 0.0);
+    printLatencies();
+
+    free(threadHandler);
+    free(threadID);
+    free(warmupCount);
+    free(threadOperations);
+}
+
+void* durationExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+    unsigned int seed = (unsigned int) time(NULL) + id;    // rand() serializes threads on its internal lock
+
+    int *rangeKeys = (int *)malloc(sizeof(int) * rangeLength);
+
+    pthread_barrier_wait(&startBarrier);
+
+    while (!__atomic_load_n(&stopFlag, __ATOMIC_RELAXED))
+    {
+        int randomValue = rand_r(&seed) % MAX_RANDOM_NUMBER;   //generate random number for operations
+        float randomFraction = (float) rand_r(&seed) / ((float) RAND_MAX + 1);   //pick the operation by its fraction
+
+        if (randomFraction < mMemberFrac)
+            executeOperation(MEMBER, randomValue, counter, rangeKeys);
+        else if (randomFraction < mMemberFrac + mInsertFrac)
+            executeOperation(INSERT, randomValue, counter, rangeKeys);
+        else if (mRangeFrac == 0 || randomFraction < mMemberFrac + mInsertFrac + mDeleteFrac)
+            executeOperation(DELETE, randomValue, counter, rangeKeys);
+        else
+            executeOperation(RANGE, randomValue, counter, rangeKeys);
+
+        __atomic_store_n(&counter->operationCount, counter->operationCount + 1, __ATOMIC_RELAXED);
+    }
+
+    free(rangeKeys);
+    return NULL;
+}
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime)
+{
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void sleepSeconds (double seconds)
+{
+    struct timespec interval;
+    interval.tv_sec = (time_t) seconds;
+    interval.tv_nsec = (long) ((seconds - interval.tv_sec) * 1e9);
+
+    while (nanosleep(&interval, &interval) != 0)
+        ;
+}
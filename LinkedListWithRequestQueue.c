@@ -0,0 +1,743 @@
+/*
+* LinkedListWithRequestQueue
+*
+* Operations are not generated by the threads that run them. Producer threads
+* submit (operation, value) requests into a bounded lock-free multi-producer
+* multi-consumer ring; consumer threads drain the ring in batches of up to
+* <batchSize> requests and run each batch against the list under one lock
+* acquisition.
+*
+* Each producer keeps at most <window> requests in flight and learns about
+* completions either by sleeping on a condition variable (blocking) or by
+* spinning on its completion count (polling). The end-to-end latency of a
+* request is measured by its producer, from just before the enqueue to the
+* moment it sees the request completed, so queueing and wake-up delays are
+* included.
+*
+* Engines:
+*   mutex  - one mutex around the list
+*   rwlock - batches of members take the read lock, any other batch the write lock
+*
+* Compile: gcc -g -Wall -o LinkedListWithRequestQueue LinkedListWithRequestQueue.c -lpthread -lm
+* Run : LinkedListWithRequestQueue [-e mutex|rwlock] [-c blocking|polling] [-b <batchSize>] [-q <queueCapacity>] [-w <window>]
+*       <n> <m> <producerCount> <consumerCount> <mMember> <mIsert> <mDelete>
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <math.h>
+
+#define MAX_RANDOM_NUMBER 65535
+#define MAX_THREAD_COUNT 1024
+#define MAX_BATCH_SIZE 1024
+#define CACHE_LINE_SIZE 64
+#define MEMBER 0
+#define INSERT 1
+#define DELETE 2
+#define ENGINE_MUTEX 0
+#define ENGINE_RWLOCK 1
+#define COMPLETION_BLOCKING 0
+#define COMPLETION_POLLING 1
+#define POLL_SPINS 64       // polls between two yields while waiting
+
+#define LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define STORE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+int n; // number of nodes in the linked list
+int m; // number of random operations in the linked list
+int producerCount = 0;
+int consumerCount = 0;
+int engine = ENGINE_MUTEX;
+int completionMode = COMPLETION_BLOCKING;
+int batchSize = 32;         // requests a consumer drains before taking the lock
+int queueCapacity = 1024;   // ring slots, a power of two
+int window = 16;            // requests a producer keeps in flight
+int stopConsumers = 0;
+
+// Fractions of each operations
+float mMemberFrac, mInsertFrac, mDeleteFrac;
+
+// operations count
+float mMember = 0;
+float mInsert = 0;
+float mDelete = 0;
+
+struct list_node_s *head = NULL;
+pthread_mutex_t mutex;
+pthread_rwlock_t rwlock;
+
+// node definition
+struct list_node_s
+{
+    int data;
+    struct list_node_s *next;
+};
+
+// one request, owned by its producer and handed to a consumer through the ring
+struct request_s
+{
+    int operation;
+    int value;
+    int result;
+    int producer;
+    int done;                       // set by the consumer once the result is in
+    struct timespec submitTime;     // taken by the producer just before the enqueue
+    struct timespec dequeueTime;    // taken by the consumer when its batch was drained
+};
+
+// ring slot: the sequence number tells whose turn it is (see enqueueRequest)
+struct ring_cell_s
+{
+    long sequence;
+    struct request_s *request;
+};
+
+// ring position, padded so that producers and consumers do not share its line
+struct ring_position_s
+{
+    long value;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct request_ring_s
+{
+    struct ring_cell_s *cells;
+    long mask;
+    struct ring_position_s enqueuePos;
+    struct ring_position_s dequeuePos;
+};
+
+// completions of one producer's requests, bumped by the consumers
+struct completion_s
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t completed;
+    long count;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// per-thread statistics, padded to a full cache line
+struct thread_counter_s
+{
+    double latencyTotal;
+    double latencyMax;
+    double queueTotal;
+    long requestCount;
+    long batchCount;
+    long fullRetries;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct request_ring_s ring;
+struct completion_s completions[MAX_THREAD_COUNT];
+struct thread_counter_s producerCounters[MAX_THREAD_COUNT];
+struct thread_counter_s consumerCounters[MAX_THREAD_COUNT];
+
+int member (int value, struct list_node_s* head_p);
+
+int insert (int value, struct list_node_s** head_pp);
+
+int delete (int value, struct list_node_s** head_pp);
+
+void initRing ();
+
+int enqueueRequest (struct request_s *request);
+
+int dequeueRequest (struct request_s **request_p);
+
+void completeRequest (struct request_s *request);
+
+long waitCompletion (int producer, long seen);
+
+void executeBatch (struct request_s *batch[], int count);
+
+void getArgs (int argc, char *argv[]);
+
+void *producerExecute (void *id);
+
+void *consumerExecute (void *id);
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime);
+
+void deleteLinkedList (struct list_node_s** head_pp);
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id);
+
+int main (int argc, char *argv[])
+{
+    struct timespec startTime, endTime;
+
+    getArgs(argc, argv);
+    mMember = mMemberFrac * m;
+    mInsert = mInsertFrac * m;
+    mDelete = mDeleteFrac * m;
+
+    // Linked list generation with non-repeat random numbers
+    for (int i =0; i < n; i++)
+    {
+        if (!insert(rand() % MAX_RANDOM_NUMBER, &head))
+            i--;
+    }
+
+    pthread_t* producerHandler = malloc(sizeof(pthread_t)* producerCount);
+    pthread_t* consumerHandler = malloc(sizeof(pthread_t)* consumerCount);
+    int idCount = producerCount > consumerCount ? producerCount : consumerCount;
+    int *threadID = (int *)malloc(sizeof(int) * idCount);
+
+    pthread_mutex_init(&mutex, NULL);
+    pthread_rwlock_init(&rwlock, NULL);
+    initRing();
+
+    for (int i = 0; i < producerCount; i++)
+    {
+        pthread_mutex_init(&completions[i].mutex, NULL);
+        pthread_cond_init(&completions[i].completed, NULL);
+        completions[i].count = 0;
+    }
+
+    for (int i = 0; i < idCount; i++)
+        threadID[i] = i;
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for (int i = 0; i < consumerCount; i++)
+        pthread_create(&consumerHandler[i], NULL, (void *) consumerExecute, (void *) &threadID[i]);
+
+    for (int i = 0; i < producerCount; i++)
+        pthread_create(&producerHandler[i], NULL, (void *) producerExecute, (void *) &threadID[i]);
+
+    // a producer only returns once all its requests are completed
+    for (int i = 0; i < producerCount; i++)
+        pthread_join(producerHandler[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    STORE(stopConsumers, 1);
+    for (int i = 0; i < consumerCount; i++)
+        pthread_join(consumerHandler[i], NULL);
+
+    double runTime = elapsedSeconds(startTime, endTime);
+    double latencyTotal = 0.0;
+    double latencyMax = 0.0;
+    double queueTotal = 0.0;
+    long requestCount = 0;
+    long batchCount = 0;
+    long fullRetries = 0;
+
+    for (int i = 0; i < producerCount; i++)
+    {
+        latencyTotal += producerCounters[i].latencyTotal;
+        queueTotal += producerCounters[i].queueTotal;
+        requestCount += producerCounters[i].requestCount;
+        fullRetries += producerCounters[i].fullRetries;
+        if (producerCounters[i].latencyMax > latencyMax)
+            latencyMax = producerCounters[i].latencyMax;
+    }
+
+    for (int i = 0; i < consumerCount; i++)
+        batchCount += consumerCounters[i].batchCount;
+
+    printf ("Time : %f\n", runTime);
+    printf ("Throughput : %f\n", requestCount / runTime);
+    printf ("Requests : %ld\n", requestCount);
+    printf ("End-to-End Latency (us) : %f\n", requestCount > 0 ? latencyTotal / requestCount * 1e6 : 0.0);
+    printf ("Max End-to-End Latency (us) : %f\n", latencyMax * 1e6);
+    printf ("Queue Latency (us) : %f\n", requestCount > 0 ? queueTotal / requestCount * 1e6 : 0.0);
+    printf ("Batches : %ld\n", batchCount);
+    printf ("Mean Batch Size : %f\n", batchCount > 0 ? (double) requestCount / batchCount : 0.0);
+    printf ("Full Queue Retries : %ld\n", fullRetries);
+
+    for (int i = 0; i < producerCount; i++)
+    {
+        pthread_mutex_destroy(&completions[i].mutex);
+        pthread_cond_destroy(&completions[i].completed);
+    }
+
+    pthread_mutex_destroy(&mutex);
+    pthread_rwlock_destroy(&rwlock);
+    deleteLinkedList(&head);
+    free(ring.cells);
+    free(producerHandler);
+    free(consumerHandler);
+    free(threadID);
+
+    return 0;
+}
+
+int member (int value, struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+
+    while (curr_p != NULL && curr_p->data < value)
+        curr_p = curr_p->next;
+
+    if (curr_p == NULL || curr_p->data > value)
+    {
+        return 0;
+    }
+    else
+    {
+       return 1;
+    }
+
+};
+
+int insert (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+    struct list_node_s* temp_p;
+
+    while (curr_p != NULL && curr_p->data <value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p == NULL || curr_p->data >value)
+    {
+        temp_p = malloc(sizeof(struct list_node_s));
+        temp_p->data = value;
+        temp_p->next = curr_p;
+
+        if (pred_p == NULL)
+            *head_pp = temp_p;
+        else
+            pred_p->next = temp_p;
+
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+int delete (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p != NULL && curr_p->data == value)
+    {
+        if (pred_p == NULL)
+        {
+            *head_pp = curr_p->next;
+            free(curr_p);
+        }
+        else
+        {
+            pred_p->next = curr_p->next;
+            free(curr_p);
+        }
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+void initRing ()
+{
+    ring.cells = malloc(sizeof(struct ring_cell_s) * queueCapacity);
+    ring.mask = queueCapacity - 1;
+    ring.enqueuePos.value = 0;
+    ring.dequeuePos.value = 0;
+
+    for (int i = 0; i < queueCapacity; i++)
+        ring.cells[i].sequence = i;
+}
+
+// claims the cell at the enqueue position once its sequence shows it is free
+// (sequence == position); publishing sets the sequence to position + 1, which
+// hands the cell to the consumer claiming that position. Returns 0 when full.
+int enqueueRequest (struct request_s *request)
+{
+    long pos = __atomic_load_n(&ring.enqueuePos.value, __ATOMIC_RELAXED);
+    struct ring_cell_s *cell;
+
+    for (;;)
+    {
+        cell = &ring.cells[pos & ring.mask];
+        long difference = LOAD(cell->sequence) - pos;
+
+        if (difference == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring.enqueuePos.value, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            pos = __atomic_load_n(&ring.enqueuePos.value, __ATOMIC_RELAXED);
+    }
+
+    cell->request = request;
+    STORE(cell->sequence, pos + 1);
+    return 1;
+}
+
+// the mirror of enqueueRequest: the cell is ready when sequence == position + 1
+// and is given back to the producers one lap later. Returns 0 when empty.
+int dequeueRequest (struct request_s **request_p)
+{
+    long pos = __atomic_load_n(&ring.dequeuePos.value, __ATOMIC_RELAXED);
+    struct ring_cell_s *cell;
+
+    for (;;)
+    {
+        cell = &ring.cells[pos & ring.mask];
+        long difference = LOAD(cell->sequence) - (pos + 1);
+
+        if (difference == 0)
+        {
+            if (__atomic_compare_exchange_n(&ring.dequeuePos.value, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (difference < 0)
+            return 0;
+        else
+            pos = __atomic_load_n(&ring.dequeuePos.value, __ATOMIC_RELAXED);
+    }
+
+    *request_p = cell->request;
+    STORE(cell->sequence, pos + ring.mask + 1);
+    return 1;
+}
+
+// marks a request done and lets its producer know
+void completeRequest (struct request_s *request)
+{
+    struct completion_s *completion = &completions[request->producer];
+
+    STORE(request->done, 1);
+
+    if (completionMode == COMPLETION_POLLING)
+    {
+        __atomic_add_fetch(&completion->count, 1, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        pthread_mutex_lock(&completion->mutex);
+        completion->count++;
+        pthread_cond_signal(&completion->completed);
+        pthread_mutex_unlock(&completion->mutex);
+    }
+}
+
+// waits until the producer has more completions than it has seen and
+// returns the new count
+long waitCompletion (int producer, long seen)
+{
+    struct completion_s *completion = &completions[producer];
+    long count;
+
+    if (completionMode == COMPLETION_POLLING)
+    {
+        for (int spins = 1; (count = LOAD(completion->count)) == seen; spins++)
+        {
+            if (spins % POLL_SPINS == 0)
+                sched_yield();
+        }
+    }
+    else
+    {
+        pthread_mutex_lock(&completion->mutex);
+        while (completion->count == seen)
+            pthread_cond_wait(&completion->completed, &completion->mutex);
+        count = completion->count;
+        pthread_mutex_unlock(&completion->mutex);
+    }
+
+    return count;
+}
+
+// runs a drained batch under a single lock acquisition
+void executeBatch (struct request_s *batch[], int count)
+{
+    int readOnly = 1;
+
+    for (int i = 0; i < count; i++)
+    {
+        if (batch[i]->operation != MEMBER)
+            readOnly = 0;
+    }
+
+    if (engine == ENGINE_MUTEX)
+        pthread_mutex_lock(&mutex);
+    else if (readOnly)
+        pthread_rwlock_rdlock(&rwlock);
+    else
+        pthread_rwlock_wrlock(&rwlock);
+
+    for (int i = 0; i < count; i++)
+    {
+        struct request_s *request = batch[i];
+
+        if (request->operation == MEMBER)
+            request->result = member(request->value, head);
+        else if (request->operation == INSERT)
+            request->result = insert(request->value, &head);
+        else
+            request->result = delete(request->value, &head);
+    }
+
+    if (engine == ENGINE_MUTEX)
+        pthread_mutex_unlock(&mutex);
+    else
+        pthread_rwlock_unlock(&rwlock);
+}
+
+void getArgs (int argc, char *argv[])
+{
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "e:c:b:q:w:")) != -1)
+    {
+        if (option == 'e' && strcmp(optarg, "mutex") == 0)
+            engine = ENGINE_MUTEX;
+        else if (option == 'e' && strcmp(optarg, "rwlock") == 0)
+            engine = ENGINE_RWLOCK;
+        else if (option == 'c' && strcmp(optarg, "blocking") == 0)
+            completionMode = COMPLETION_BLOCKING;
+        else if (option == 'c' && strcmp(optarg, "polling") == 0)
+            completionMode = COMPLETION_POLLING;
+        else if (option == 'b')
+            batchSize = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 'q')
+            queueCapacity = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 'w')
+            window = (int) strtol(optarg, (char **) NULL, 10);
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 7)
+    {
+        printf("Enter LinkedListWithRequestQueue [-e mutex|rwlock] [-c blocking|polling] [-b <batchSize>] [-q <queueCapacity>] [-w <window>] <n> <m> <producerCount> <consumerCount> <mMember> <mInsert> <mDelete> \n");
+        exit(0);
+    }
+
+    argv += optind - 1;     // positional arguments follow the options
+
+    n = (int) strtol(argv[1], (char **) NULL, 10);
+    m = (int) strtol(argv[2], (char **) NULL, 10);
+    producerCount = (int) strtol(argv[3], (char **) NULL, 10);
+    consumerCount = (int) strtol(argv[4], (char **) NULL, 10);
+
+    mMemberFrac = (float) atof(argv[5]);
+    mInsertFrac = (float) atof(argv[6]);
+    mDeleteFrac = (float) atof(argv[7]);
+
+    // validating thread counts
+    if (producerCount <= 0 || producerCount > MAX_THREAD_COUNT
+        || consumerCount <= 0 || consumerCount > MAX_THREAD_COUNT)
+    {
+        printf ("Thread count is incorrect \n");
+        exit(0);
+    }
+
+    // validating the queue
+    if (batchSize <= 0 || batchSize > MAX_BATCH_SIZE || window <= 0
+        || queueCapacity < 2 || (queueCapacity & (queueCapacity - 1)) != 0)
+    {
+        printf ("Batch size should be between 1 and %d, window positive and queue capacity a power of two \n", MAX_BATCH_SIZE);
+        exit(0);
+    }
+
+    // arg validation
+    if (n <= 0 || m <= 0 || fabsf(mMemberFrac + mInsertFrac + mDeleteFrac - 1.0f) > 1e-5)
+    {
+        printf ("Please give the command with the arguments: ./LinkedListWithRequestQueue <n> <m> <producerCount> <consumerCount> <mMember> <mInsert> <mDelete> \n");
+
+        if (n <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+
+        if (m <= 0)
+            printf ("Value you entered for m is incorrect! \n");
+
+        if (fabsf(mMemberFrac + mInsertFrac + mDeleteFrac - 1.0f) > 1e-5)
+            printf ("mMember + mInsert + mDelete should equals to 1 \n");
+
+        exit(0);
+    }
+};
+
+// submits this producer's share of the operations, keeping at most <window>
+// requests in flight, and records the latency of each one as it completes
+void* producerExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &producerCounters[id];
+    unsigned int seed = id + 1;
+
+    // generate local no of operations without loss
+    int localMemberCount = generateLocalNumberOfOperations(mMember, producerCount, id);
+    int localInsertCount = generateLocalNumberOfOperations(mInsert, producerCount, id);
+    int localDeleteCount = generateLocalNumberOfOperations(mDelete, producerCount, id);
+
+    int local_m = localMemberCount + localInsertCount + localDeleteCount;
+
+    struct request_s *requests = malloc(sizeof(struct request_s) * window);
+    int *inFlight = calloc(window, sizeof(int));
+    int *freeSlots = malloc(sizeof(int) * window);
+    int freeCount = window;
+
+    for (int i = 0; i < window; i++)
+        freeSlots[i] = i;
+
+    int memberCount = 0;
+    int insertCount = 0;
+    int deleteCount = 0;
+    int reaped = 0;
+    long seen = 0;
+
+    while (reaped < local_m)
+    {
+        // fill the window
+        while (freeCount > 0 && memberCount + insertCount + deleteCount < local_m)
+        {
+            int randomValue = rand_r(&seed) % MAX_RANDOM_NUMBER;   //generate random number for operations
+            int randomOperation = rand_r(&seed) % 3;  //generate random operation type
+
+            if (randomOperation == MEMBER && memberCount < localMemberCount)
+                memberCount++;
+            else if (randomOperation == INSERT && insertCount < localInsertCount)
+                insertCount++;
+            else if (randomOperation == DELETE && deleteCount < localDeleteCount)
+                deleteCount++;
+            else
+                continue;
+
+            int slot = freeSlots[--freeCount];
+            struct request_s *request = &requests[slot];
+
+            request->operation = randomOperation;
+            request->value = randomValue;
+            request->producer = id;
+            request->done = 0;
+            inFlight[slot] = 1;
+
+            clock_gettime(CLOCK_MONOTONIC, &request->submitTime);
+
+            while (!enqueueRequest(request))
+            {
+                counter->fullRetries++;
+                sched_yield();
+            }
+        }
+
+        seen = waitCompletion(id, seen);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        // reap everything that completed since the last wake-up
+        for (int slot = 0; slot < window; slot++)
+        {
+            if (!inFlight[slot] || !LOAD(requests[slot].done))
+                continue;
+
+            double latency = elapsedSeconds(requests[slot].submitTime, now);
+            counter->latencyTotal += latency;
+            counter->queueTotal += elapsedSeconds(requests[slot].submitTime, requests[slot].dequeueTime);
+            counter->requestCount++;
+            if (latency > counter->latencyMax)
+                counter->latencyMax = latency;
+
+            inFlight[slot] = 0;
+            freeSlots[freeCount++] = slot;
+            reaped++;
+        }
+    }
+
+    free(requests);
+    free(inFlight);
+    free(freeSlots);
+    return NULL;
+}
+
+// drains up to <batchSize> requests at a time until the producers are done
+void* consumerExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &consumerCounters[id];
+    struct request_s *batch[MAX_BATCH_SIZE];
+
+    while (!LOAD(stopConsumers))
+    {
+        int count = 0;
+
+        while (count < batchSize && dequeueRequest(&batch[count]))
+            count++;
+
+        if (count == 0)
+        {
+            sched_yield();
+            continue;
+        }
+
+        struct timespec dequeueTime;
+        clock_gettime(CLOCK_MONOTONIC, &dequeueTime);
+
+        for (int i = 0; i < count; i++)
+            batch[i]->dequeueTime = dequeueTime;
+
+        executeBatch(batch, count);
+
+        for (int i = 0; i < count; i++)
+            completeRequest(batch[i]);
+
+        counter->requestCount += count;
+        counter->batchCount++;
+    }
+    return NULL;
+}
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime)
+{
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void deleteLinkedList (struct list_node_s** head_pp)
+{
+   struct list_node_s* current = *head_pp;
+   struct list_node_s* next;
+
+   while (current != NULL)
+   {
+       next = current->next;
+       free(current);
+       current = next;
+   }
+
+   *head_pp = NULL;
+}
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id)
+{
+    int localOperationCount = 0;
+
+    if (noOfOperations % threadCount == 0|| noOfOperations % threadCount <= id)
+    {
+        localOperationCount = noOfOperations / threadCount;
+    }
+    else if (noOfOperations % threadCount > id)
+    {
+        localOperationCount = noOfOperations / threadCount + 1;
+    }
+
+    return localOperationCount;
+}
@@ -0,0 +1,856 @@
+/*
+* LinkedListWithSeqLock
+*
+* Readers never write to shared memory: they read the list version before and
+* after the traversal and retry when a writer changed it in between. Writers
+* are serialized by a mutex and keep the version odd while they modify the list.
+*
+* Compile: gcc -g -Wall -o LinkedListWithSeqLock LinkedListWithSeqLock.c -lpthread -lm
+* Run : LinkedListWithSeqLock [-d <duration> [-w <warmup>]] [-r <mRange> [-l <rangeLength>] [-c]]
+*       <n> <m> <threadCount> <mMember> <mIsert> <mDelete>
+*
+* With -d the threads run the operation mix for <duration> seconds instead of
+* splitting m operations, after an optional <warmup> excluded from measurement.
+*
+* With -r a fraction of the operations are range queries over <rangeLength>
+* consecutive keys, counting them or, with -c, collecting them in order.
+* These runs and duration mode also report the mean latency of each operation
+* type; plain runs do not time single operations, so their Mean/STD stays
+* comparable with the serial program.
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <math.h>
+#include <unistd.h>
+#include <sched.h>
+
+#define MAX_RANDOM_NUMBER 65535
+#define MAX_THREAD_COUNT 1024
+#define CACHE_LINE_SIZE 64
+#define MEMBER 0
+#define INSERT 1
+#define DELETE 2
+#define RANGE 3
+#define OPERATION_TYPES 4
+#define RETRY -1
+#define VALIDATE_INTERVAL 64    // nodes a reader traverses between version checks
+
+// node fields are read by readers while a writer may change them
+#define LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#define STORE(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+
+int n; // number of nodes in the linked list
+int m; // number of random operations in the linked list
+int threadCount = 0;
+int sampleSize = 65;    // number of samples considered
+
+// duration mode
+double duration = 0;    // seconds to run the mix for, 0 runs the fixed m operations
+double warmup = 0;      // seconds run before the measurement starts
+int stopFlag = 0;       // set by main once the duration has elapsed
+pthread_barrier_t startBarrier;
+int measuring = 1;      // latencies are only recorded while set, cleared during warm-up
+int recordLatencies = 0;    // time every operation, set with -r or -d
+
+// range queries
+int rangeLength = 100;  // number of consecutive keys covered by a range query
+int collectKeys = 0;    // range queries collect the keys instead of counting them
+
+// Fractions of each operations
+float mMemberFrac, mInsertFrac, mDeleteFrac;
+float mRangeFrac = 0;
+
+// operations count
+float mMember = 0;
+float mInsert = 0;
+float mDelete = 0;
+float mRange = 0;
+
+// latency of each operation type, summed over all samples
+double latencyTotal[OPERATION_TYPES];
+long latencyCount[OPERATION_TYPES];
+const char *operationNames[OPERATION_TYPES] = { "Member", "Insert", "Delete", "Range" };
+
+struct list_node_s *head = NULL;
+
+// node definition
+struct list_node_s
+{
+    int data;
+    struct list_node_s *next;
+};
+
+// per-thread operation counter, latencies and read retries, padded to a full cache line
+struct thread_counter_s
+{
+    long operationCount;    // operations completed in duration mode
+    double latencyTotal[OPERATION_TYPES];
+    long latencyCount[OPERATION_TYPES];
+    long readCount;
+    long retryCount;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+// the version is read by every reader and the mutex only by writers,
+// so each gets a cache line of its own
+struct padded_version_s
+{
+    unsigned long version;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct padded_mutex_s
+{
+    pthread_mutex_t mutex;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct thread_counter_s threadCounters[MAX_THREAD_COUNT];
+struct padded_version_s listVersion;
+struct padded_mutex_s writerMutex;
+
+// deleted nodes are kept on a free list guarded by the writer mutex and reused
+// by insert instead of being freed, so a reader holding a stale pointer always
+// reads a valid node and is sent back by the version check
+struct list_node_s *freeNodes = NULL;
+
+// read retries over all samples
+long totalReads, totalRetries;
+
+int member (int value, struct list_node_s* head_p, unsigned long version);
+
+int insert (int value, struct list_node_s** head_pp);
+
+int delete (int value, struct list_node_s** head_pp);
+
+int countRange (int low, int high, struct list_node_s* head_p, unsigned long version);
+
+int collectRange (int low, int high, int keys[], struct list_node_s* head_p, unsigned long version);
+
+unsigned long readBegin ();
+
+int readValidate (unsigned long version);
+
+void writeBegin ();
+
+void writeEnd ();
+
+struct list_node_s *allocateNode ();
+
+void freeNode (struct list_node_s *node);
+
+void getArgs (int argc, char *argv[]);
+
+void *threadExecute (void *id);
+
+void executeOperation (int operation, int value, struct thread_counter_s *counter, int rangeKeys[]);
+
+void aggregateStatistics (struct thread_counter_s *counter);
+
+void printStatistics ();
+
+void *durationExecute (void *id);
+
+void runDurationMode ();
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime);
+
+void sleepSeconds (double seconds);
+
+void deleteLinkedList (struct list_node_s** head_pp);
+
+float calculateSTD (double data[], float mean);
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id);
+ 
+int main (int argc, char *argv[])
+{
+    double timeArray[sampleSize];  // store total time taken for each sample
+    double totalTime = 0.0;
+    float mean= 0.0;
+    float std = 0.0;
+
+    getArgs(argc, argv);
+    mMember = mMemberFrac * m;
+    mInsert = mInsertFrac * m;
+    mDelete = mDeleteFrac * m;
+    mRange = mRangeFrac * m;
+
+    if (duration > 0)
+    {
+        runDurationMode();
+        return 0;
+    }
+
+    for (int j = 0; j < sampleSize; j++)
+    {
+        pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+        clock_t startTime, endTime;
+
+        int *threadID = (int *)malloc(sizeof(int) * threadCount);
+
+        // Linked list generation with non-repeating random numbers
+        int i = 0;
+        for (; i < n; i++)
+        {
+            if (!insert(rand() % MAX_RANDOM_NUMBER, &head))
+                i--;
+        }
+
+        // initializing the writer mutex
+        pthread_mutex_init(&writerMutex.mutex, NULL);
+
+        startTime = clock();
+
+        // thread creation
+        i = 0;
+        while (i < threadCount)
+        {
+            threadID[i] = i;
+            pthread_create(&threadHandler[i], NULL, (void *) threadExecute, (void *) &threadID[i]);
+            i++;
+        }
+
+        // thread join 
+        i = 0;
+        while (i < threadCount)
+        {
+            pthread_join(threadHandler[i], NULL);
+            aggregateStatistics(&threadCounters[i]);
+            i++;
+        }
+
+        endTime = clock();
+
+        // destroying the writer mutex
+        pthread_mutex_destroy(&writerMutex.mutex);
+
+        timeArray[j] = ((double) (endTime - startTime)) / CLOCKS_PER_SEC;
+        totalTime += timeArray[j];
+        deleteLinkedList(&head);
+
+    }
+
+    mean = totalTime / sampleSize;  // mean time calculation
+    std = calculateSTD(timeArray, mean);    // std calculation
+
+    printf ("Mean : %f\n", mean);
+    printf ("STD : %f\n", std);
+    printStatistics();
+
+    return 0;
+    
+}
+
+// optimistic traversal, returns RETRY as soon as a writer is seen to have
+// changed the list; the caller validates the version once more at the end
+int member (int value, struct list_node_s* head_p, unsigned long version)
+{
+    struct list_node_s* curr_p = head_p;
+    int steps = 0;
+
+    while (curr_p != NULL && LOAD(curr_p->data) < value)
+    {
+        curr_p = LOAD(curr_p->next);
+
+        if (++steps % VALIDATE_INTERVAL == 0 && !readValidate(version))
+            return RETRY;
+    }
+
+    if (curr_p == NULL || LOAD(curr_p->data) > value)
+    {
+        return 0;
+    }
+    else
+    {
+       return 1;
+    }
+
+};
+
+// called with the writer mutex held
+int insert (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+    struct list_node_s* temp_p;
+
+    while (curr_p != NULL && curr_p->data <value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p == NULL || curr_p->data >value)
+    {
+        temp_p = allocateNode();
+
+        writeBegin();
+        STORE(temp_p->data, value);
+        STORE(temp_p->next, curr_p);
+
+        if (pred_p == NULL)
+            STORE(*head_pp, temp_p);
+        else
+            STORE(pred_p->next, temp_p);
+        writeEnd();
+
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+// called with the writer mutex held
+int delete (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p != NULL && curr_p->data == value)
+    {
+        writeBegin();
+        if (pred_p == NULL)
+            STORE(*head_pp, curr_p->next);
+        else
+            STORE(pred_p->next, curr_p->next);
+        freeNode(curr_p);
+        writeEnd();
+
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+// counts the keys in [low, high]; the result is only a consistent snapshot
+// once the caller has validated the version it started with
+int countRange (int low, int high, struct list_node_s* head_p, unsigned long version)
+{
+    struct list_node_s* curr_p = head_p;
+    int count = 0;
+    int steps = 0;
+
+    while (curr_p != NULL && LOAD(curr_p->data) < low)
+    {
+        curr_p = LOAD(curr_p->next);
+
+        if (++steps % VALIDATE_INTERVAL == 0 && !readValidate(version))
+            return RETRY;
+    }
+
+    while (curr_p != NULL && LOAD(curr_p->data) <= high)
+    {
+        count++;
+        curr_p = LOAD(curr_p->next);
+
+        if (++steps % VALIDATE_INTERVAL == 0 && !readValidate(version))
+            return RETRY;
+    }
+
+    return count;
+}
+
+// copies the keys in [low, high] into keys in ascending order and returns
+// how many were copied; keys must have room for high - low + 1 entries
+int collectRange (int low, int high, int keys[], struct list_node_s* head_p, unsigned long version)
+{
+    struct list_node_s* curr_p = head_p;
+    int count = 0;
+    int steps = 0;
+
+    while (curr_p != NULL && LOAD(curr_p->data) < low)
+    {
+        curr_p = LOAD(curr_p->next);
+
+        if (++steps % VALIDATE_INTERVAL == 0 && !readValidate(version))
+            return RETRY;
+    }
+
+    while (curr_p != NULL && LOAD(curr_p->data) <= high)
+    {
+        // a consistent list holds no more keys than the range has values
+        if (count == high - low + 1)
+            return RETRY;
+
+        keys[count++] = LOAD(curr_p->data);
+        curr_p = LOAD(curr_p->next);
+
+        if (++steps % VALIDATE_INTERVAL == 0 && !readValidate(version))
+            return RETRY;
+    }
+
+    return count;
+}
+
+// waits until no writer is active and returns the version to validate against
+unsigned long readBegin ()
+{
+    unsigned long version;
+
+    while ((version = __atomic_load_n(&listVersion.version, __ATOMIC_ACQUIRE)) & 1)
+        sched_yield();
+
+    return version;
+}
+
+// true when no writer has started since readBegin returned version
+int readValidate (unsigned long version)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&listVersion.version, __ATOMIC_RELAXED) == version;
+}
+
+void writeBegin ()
+{
+    __atomic_store_n(&listVersion.version, LOAD(listVersion.version) + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void writeEnd ()
+{
+    __atomic_store_n(&listVersion.version, LOAD(listVersion.version) + 1, __ATOMIC_RELEASE);
+}
+
+// takes a node from the free list, called with the writer mutex held
+struct list_node_s *allocateNode ()
+{
+    struct list_node_s *node = freeNodes;
+
+    if (node == NULL)
+        return malloc(sizeof(struct list_node_s));
+
+    freeNodes = node->next;
+    return node;
+}
+
+// returns a node to the free list, called between writeBegin and writeEnd
+void freeNode (struct list_node_s *node)
+{
+    STORE(node->next, freeNodes);
+    freeNodes = node;
+}
+
+void getArgs (int argc, char *argv[])
+{
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "d:w:r:l:c")) != -1)
+    {
+        if (option == 'd')
+            duration = atof(optarg);
+        else if (option == 'w')
+            warmup = atof(optarg);
+        else if (option == 'r')
+            mRangeFrac = (float) atof(optarg);
+        else if (option == 'l')
+            rangeLength = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 'c')
+            collectKeys = 1;
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 6)
+    {
+        printf("Enter LinkedListWithSeqLock [-d <duration> [-w <warmup>]] [-r <mRange> [-l <rangeLength>] [-c]] <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+        exit(0);
+    }
+
+    argv += optind - 1;     // positional arguments follow the options
+
+    n = (int) strtol(argv[1], (char **) NULL, 10);
+    m = (int) strtol(argv[2], (char **) NULL, 10);
+    threadCount = (int) strtol(argv[3], (char **) NULL, 10);
+
+    mMemberFrac = (float) atof(argv[4]);
+    mInsertFrac = (float) atof(argv[5]);
+    mDeleteFrac = (float) atof(argv[6]);
+
+    // validating thread count
+    if (threadCount <= 0 || threadCount > MAX_THREAD_COUNT)
+    {
+        printf ("Thread count is incorrect \n");
+        exit(0);
+    }
+
+    recordLatencies = mRangeFrac > 0 || duration > 0;
+
+    // validating duration mode
+    if (duration < 0 || warmup < 0 || (warmup > 0 && duration == 0))
+    {
+        printf ("Duration and warm-up should be positive, and warm-up needs a duration \n");
+        exit(0);
+    }
+
+    // validating range queries
+    if (mRangeFrac < 0 || rangeLength <= 0)
+    {
+        printf ("Range fraction and range length should be positive \n");
+        exit(0);
+    }
+
+    // arg validation
+    if (n <= 0 || m <= 0 || fabsf(mMemberFrac + mInsertFrac + mDeleteFrac + mRangeFrac - 1.0f) > 1e-5)
+    {
+        printf ("Please give the command with the arguments: ./serial_linked list <n> <m> <mMember> <mInsert> <mDelete> \n");
+
+        if (n <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+        
+        if (m <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+
+        if (fabsf(mMemberFrac + mInsertFrac + mDeleteFrac + mRangeFrac - 1.0f) > 1e-5)
+            printf ("mMember + mInsert + mDelete + mRange should equals to 1 \n");
+        
+        exit(0);
+    }
+};
+
+void* threadExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+    int *rangeKeys = (int *)malloc(sizeof(int) * rangeLength);
+
+    // generate local no of member operationswithout loss
+    int localMemberCount = generateLocalNumberOfOperations(mMember, threadCount, id);
+    int localInsertCount = generateLocalNumberOfOperations(mInsert, threadCount, id);
+    int localDeleteCount = generateLocalNumberOfOperations(mDelete, threadCount, id);
+    int localRangeCount = generateLocalNumberOfOperations(mRange, threadCount, id);
+
+    int local_m = localMemberCount + localInsertCount + localDeleteCount + localRangeCount;
+    int operationTypes = mRangeFrac > 0 ? OPERATION_TYPES : 3;
+
+    *counter = (struct thread_counter_s) { 0 };
+
+    int totalCount = 0;
+    int memberCount = 0;
+    int insertCount = 0;
+    int deleteCount = 0;
+    int rangeCount = 0;
+
+    int i = 0;
+    while(totalCount < local_m)
+    {
+        int randomValue = rand() % MAX_RANDOM_NUMBER;   //generate random number for operations
+        int randomOperation = rand() % operationTypes;  //generate random operation type
+
+        if(randomOperation == MEMBER)
+        {
+            if (memberCount < localMemberCount)
+            {
+                executeOperation(MEMBER, randomValue, counter, rangeKeys);
+                memberCount++;
+            }
+        }
+        else if(randomOperation == INSERT)
+        {
+            if (insertCount < localInsertCount)
+            {
+                executeOperation(INSERT, randomValue, counter, rangeKeys);
+                insertCount++;
+            }
+        }
+        else if(randomOperation == DELETE)
+        {
+            if (deleteCount < localDeleteCount)
+            {
+                executeOperation(DELETE, randomValue, counter, rangeKeys);
+                deleteCount++;
+            }
+        }
+        else if(randomOperation == RANGE)
+        {
+            if (rangeCount < localRangeCount)
+            {
+                executeOperation(RANGE, randomValue, counter, rangeKeys);
+                rangeCount++;
+            }
+        }
+
+        totalCount = memberCount + insertCount + deleteCount + rangeCount;
+        i++;
+    }
+
+    free(rangeKeys);
+    return NULL;
+}
+
+// runs one operation and records its latency; readers retry until the
+// version they started with is still current at the end of their traversal
+void executeOperation (int operation, int value, struct thread_counter_s *counter, int rangeKeys[])
+{
+    struct timespec startTime, endTime;
+    int attempts = 0;
+
+    if (recordLatencies)
+        clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    if (operation == INSERT || operation == DELETE)
+    {
+        pthread_mutex_lock(&writerMutex.mutex);
+        if (operation == INSERT)
+            insert(value, &head);
+        else
+            delete(value, &head);
+        pthread_mutex_unlock(&writerMutex.mutex);
+    }
+    else
+    {
+        unsigned long version;
+        int result;
+
+        do
+        {
+            version = readBegin();
+            attempts++;
+
+            if (operation == MEMBER)
+                result = member(value, LOAD(head), version);
+            else if (collectKeys)
+                result = collectRange(value, value + rangeLength - 1, rangeKeys, LOAD(head), version);
+            else
+                result = countRange(value, value + rangeLength - 1, LOAD(head), version);
+        } while (result == RETRY || !readValidate(version));
+    }
+
+    if (recordLatencies)
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    if (__atomic_load_n(&measuring, __ATOMIC_RELAXED))
+    {
+        if (recordLatencies)
+        {
+            counter->latencyTotal[operation] += elapsedSeconds(startTime, endTime);
+            counter->latencyCount[operation]++;
+        }
+
+        if (attempts > 0)
+        {
+            counter->readCount++;
+            counter->retryCount += attempts - 1;
+        }
+    }
+}
+
+void aggregateStatistics (struct thread_counter_s *counter)
+{
+    for (int i = 0; i < OPERATION_TYPES; i++)
+    {
+        latencyTotal[i] += counter->latencyTotal[i];
+        latencyCount[i] += counter->latencyCount[i];
+    }
+
+    totalReads += counter->readCount;
+    totalRetries += counter->retryCount;
+}
+
+// prints the mean latency in microseconds of every operation type that ran
+// and the mean number of retries per read
+void printStatistics ()
+{
+    for (int i = 0; i < OPERATION_TYPES; i++)
+    {
+        if (latencyCount[i] > 0)
+            printf ("%s Latency (us) : %f\n", operationNames[i], latencyTotal[i] / latencyCount[i] * 1e6);
+    }
+
+    if (totalReads > 0)
+        printf ("Read Retries : %f\n", (double) totalRetries / totalReads);
+}
+
+float calculateSTD (double data[], float mean)
+{
+    float standardDeviation = 0.0; 
+
+    for (int i = 0; i < sampleSize; ++i)
+        standardDeviation += pow(data[i] - mean, 2);
+
+    return sqrt(standardDeviation / sampleSize);
+}
+
+void deleteLinkedList (struct list_node_s** head_pp)
+{ 
+   struct list_node_s* current = *head_pp; 
+   struct list_node_s* next; 
+  
+   while (current != NULL)  
+   { 
+       next = current->next; 
+       free(current); 
+       current = next; 
+   } 
+   
+   *head_pp = NULL;
+
+   // the nodes kept for reuse are released along with the list
+   while (freeNodes != NULL)
+   {
+       next = freeNodes->next;
+       free(freeNodes);
+       freeNodes = next;
+   }
+}
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id)
+{
+    int localOperationCount = 0;
+
+    if (noOfOperations % threadCount == 0|| noOfOperations % threadCount <= id)
+    {
+        localOperationCount = noOfOperations / threadCount;
+    }
+    else if (noOfOperations % threadCount > id)
+    {
+        localOperationCount = noOfOperations / threadCount + 1;
+    }
+
+    return localOperationCount;
+}
+
+// runs the operation mix on all threads for the given duration and reports
+// the throughput of every thread along with the fairness between them
+void runDurationMode ()
+{
+    pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+    int *threadID = (int *)malloc(sizeof(int) * threadCount);
+    long *warmupCount = (long *)malloc(sizeof(long) * threadCount);
+    long *threadOperations = (long *)malloc(sizeof(long) * threadCount);
+    struct timespec startTime, endTime;
+
+    // Linked list generation with non-repeat random numbers
+    for (int i =0; i < n; i++)
+    {
+        if (!insert(rand() % MAX_RANDOM_NUMBER, &head))
+            i--;
+    }
+
+    pthread_mutex_init(&writerMutex.mutex, NULL);
+    pthread_barrier_init(&startBarrier, NULL, threadCount + 1);
+    stopFlag = 0;
+    measuring = warmup == 0;
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        threadID[k] = k;
+        threadCounters[k] = (struct thread_counter_s) { 0 };
+        pthread_create (&threadHandler[k], NULL, (void *) durationExecute, (void *) &threadID[k]);
+    }
+
+    // all threads start together, the warm-up operations are subtracted later
+    pthread_barrier_wait(&startBarrier);
+    sleepSeconds(warmup);
+
+    __atomic_store_n(&measuring, 1, __ATOMIC_RELAXED);
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    for (int k = 0; k < threadCount; k++)
+        warmupCount[k] = __atomic_load_n(&threadCounters[k].operationCount, __ATOMIC_RELAXED);
+
+    sleepSeconds(duration);
+
+    for (int k = 0; k < threadCount; k++)
+        threadOperations[k] = __atomic_load_n(&threadCounters[k].operationCount, __ATOMIC_RELAXED) - warmupCount[k];
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    __atomic_store_n(&stopFlag, 1, __ATOMIC_RELAXED);
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        pthread_join (threadHandler[k], NULL);
+        aggregateStatistics(&threadCounters[k]);
+    }
+
+    pthread_barrier_destroy(&startBarrier);
+    pthread_mutex_destroy(&writerMutex.mutex);
+    deleteLinkedList(&head);
+
+    double measuredTime = elapsedSeconds(startTime, endTime);
+    long totalOperations = 0;
+    long minOperations = threadOperations[0];
+    long maxOperations = threadOperations[0];
+
+    for (int k = 0; k < threadCount; k++)
+    {
+        totalOperations += threadOperations[k];
+        if (threadOperations[k] < minOperations)
+            minOperations = threadOperations[k];
+        if (threadOperations[k] > maxOperations)
+            maxOperations = threadOperations[k];
+    }
+
+    printf ("Duration : %f\n", measuredTime);
+    printf ("Total Throughput : %f\n", totalOperations / measuredTime);
+
+    for (int k = 0; k < threadCount; k++)
+        printf ("Thread %d Throughput : %f\n", k, threadOperations[k] / measuredTime);
+
+    // share of the total operations done by the slowest and the fastest thread
+    printf ("Min Thread Share : %f\n", totalOperations > 0 ? (double) minOperations / totalOperations : 0.0);
+    printf ("Max Thread Share : %f\n", totalOperations > 0 ? (double) maxOperations / totalOperations : 0.0);
+    printf ("Fairness : %f\n", maxOperations > 0 ? (double) minOperations / maxOperations : 0.0);
+    printStatistics();
+
+    free(threadHandler);
+    free(threadID);
+    free(warmupCount);
+    free(threadOperations);
+}
+
+void* durationExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+    unsigned int seed = (unsigned int) time(NULL) + id;    // rand() serializes threads on its internal lock
+
+    int *rangeKeys = (int *)malloc(sizeof(int) * rangeLength);
+
+    pthread_barrier_wait(&startBarrier);
+
+    while (!__atomic_load_n(&stopFlag, __ATOMIC_RELAXED))
+    {
+        int randomValue = rand_r(&seed) % MAX_RANDOM_NUMBER;   //generate random number for operations
+        float randomFraction = (float) rand_r(&seed) / ((float) RAND_MAX + 1);   //pick the operation by its fraction
+
+        if (randomFraction < mMemberFrac)
+            executeOperation(MEMBER, randomValue, counter, rangeKeys);
+        else if (randomFraction < mMemberFrac + mInsertFrac)
+            executeOperation(INSERT, randomValue, counter, rangeKeys);
+        else if (mRangeFrac == 0 || randomFraction < mMemberFrac + mInsertFrac + mDeleteFrac)
+            executeOperation(DELETE, randomValue, counter, rangeKeys);
+        else
+            executeOperation(RANGE, randomValue, counter, rangeKeys);
+
+        __atomic_store_n(&counter->operationCount, counter->operationCount + 1, __ATOMIC_RELAXED);
+    }
+
+    free(rangeKeys);
+    return NULL;
+}
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime)
+{
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void sleepSeconds (double seconds)
+{
+    struct timespec interval;
+    interval.tv_sec = (time_t) seconds;
+    interval.tv_nsec = (long) ((seconds - interval.tv_sec) * 1e9);
+
+    while (nanosleep(&interval, &interval) != 0)
+        ;
+}
@@ -0,0 +1,773 @@
+/*
+* LinkedListWithWAL
+*
+* Read-write lock list whose inserts and deletes are made durable through an
+* append-only write-ahead log. Workers append a record while they hold the
+* write lock, so the log order is the order the list was changed in, and then
+* wait outside the lock until a dedicated flusher thread has written the
+* batch holding their record (group commit).
+*
+* Sync policies:
+*   none     - records are written to the file, never synced
+*   interval - records are written at once and synced every <syncInterval> ms
+*   batch    - every batch is synced before its records are committed
+*
+* On startup the log is replayed into the list; a torn record at the tail is
+* cut off. The list is then filled up to n nodes and the log is checkpointed:
+* it is rewritten as one insert per node of the current list, synced and
+* renamed over the old log, so it never holds more than the list plus one run
+* of changes and recovery does not replay the whole history. The random
+* numbers are seeded per run, so a run after recovery does not replay the
+* values of the one before it.
+*
+* A failed write or sync of the log is fatal: no record is reported durable
+* unless it was written in full and synced as the policy requires.
+*
+* Compile: gcc -g -Wall -o LinkedListWithWAL LinkedListWithWAL.c -lpthread -lm
+* Run : LinkedListWithWAL [-s none|interval|batch] [-i <syncInterval>] [-t] <logFile> <n> <m> <threadCount> <mMember> <mIsert> <mDelete>
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <math.h>
+
+#define MAX_RANDOM_NUMBER 65535
+#define MAX_THREAD_COUNT 1024
+#define CACHE_LINE_SIZE 64
+#define MEMBER 0
+#define INSERT 1
+#define DELETE 2
+#define SYNC_NONE 0
+#define SYNC_INTERVAL 1
+#define SYNC_BATCH 2
+#define LOG_BUFFER_RECORDS 4096     // records a batch can hold
+#define LOG_CHECKSUM_SEED 0x5a5a5a5au
+
+int n; // number of nodes in the linked list
+int m; // number of random operations in the linked list
+int threadCount = 0;
+int syncPolicy = SYNC_BATCH;
+int syncInterval = 10;      // milliseconds between syncs for the interval policy
+int truncateLog = 0;        // start from an empty log instead of recovering
+char *logPath;
+
+// Fractions of each operations
+float mMemberFrac, mInsertFrac, mDeleteFrac;
+
+// operations count
+float mMember = 0;
+float mInsert = 0;
+float mDelete = 0;
+
+struct list_node_s *head = NULL;
+pthread_rwlock_t rwlock;
+
+// node definition
+struct list_node_s
+{
+    int data;
+    struct list_node_s *next;
+};
+
+// one logged insert or delete
+struct log_record_s
+{
+    int operation;
+    int value;
+    unsigned int checksum;
+};
+
+// the log: workers fill the active buffer while the flusher writes the other one
+struct write_ahead_log_s
+{
+    int fd;
+    pthread_t flusher;
+    pthread_mutex_t mutex;
+    pthread_cond_t flushNeeded;     // signalled by workers after appending
+    pthread_cond_t flushDone;       // broadcast by the flusher after each batch
+    struct log_record_s *active;
+    struct log_record_s *flushing;
+    int activeCount;
+    long appendedLsn;       // sequence number of the last appended record
+    long durableLsn;        // last record committed under the sync policy
+    int stop;
+    long batchCount;
+    long syncCount;
+};
+
+// per-thread commit latencies, padded to a full cache line
+struct thread_counter_s
+{
+    double commitTotal;
+    double commitMax;
+    long commitCount;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct write_ahead_log_s wal;
+struct thread_counter_s threadCounters[MAX_THREAD_COUNT];
+
+int member (int value, struct list_node_s* head_p);
+
+int insert (int value, struct list_node_s** head_pp);
+
+int delete (int value, struct list_node_s** head_pp);
+
+long recoverLog ();
+
+long checkpointLog ();
+
+void syncDirectory ();
+
+void startLog ();
+
+void stopLog ();
+
+long appendLog (int operation, int value);
+
+void waitDurable (long lsn);
+
+void *flusherExecute ();
+
+void writeLog (struct log_record_s *records, int recordCount);
+
+void syncLog ();
+
+unsigned int recordChecksum (int operation, int value);
+
+void getArgs (int argc, char *argv[]);
+
+void *threadExecute (void *id);
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime);
+
+void deleteLinkedList (struct list_node_s** head_pp);
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id);
+
+int main (int argc, char *argv[])
+{
+    struct timespec startTime, endTime;
+
+    getArgs(argc, argv);
+    srand(time(NULL) ^ getpid());
+    mMember = mMemberFrac * m;
+    mInsert = mInsertFrac * m;
+    mDelete = mDeleteFrac * m;
+
+    // crash recovery: replay the log into the list
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    long recovered = recoverLog();
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    printf ("Recovered Records : %ld\n", recovered);
+    printf ("Recovery Time : %f\n", elapsedSeconds(startTime, endTime));
+
+    // Linked list generation with non-repeat random numbers, made durable by the checkpoint
+    int listSize = 0;
+    for (struct list_node_s *curr_p = head; curr_p != NULL; curr_p = curr_p->next)
+        listSize++;
+
+    for (; listSize < n && listSize < MAX_RANDOM_NUMBER; listSize++)
+    {
+        if (!insert(rand() % MAX_RANDOM_NUMBER, &head))
+            listSize--;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    long checkpointed = checkpointLog();
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    printf ("Checkpoint Records : %ld\n", checkpointed);
+    printf ("Checkpoint Time : %f\n", elapsedSeconds(startTime, endTime));
+
+    startLog();
+
+    pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+    int *threadID = (int *)malloc(sizeof(int) * threadCount);
+    long batchesBefore = wal.batchCount;
+
+    pthread_rwlock_init(&rwlock, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        threadID[i] = i;
+        pthread_create(&threadHandler[i], NULL, (void *) threadExecute, (void *) &threadID[i]);
+    }
+
+    for (int i = 0; i < threadCount; i++)
+        pthread_join(threadHandler[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    pthread_rwlock_destroy(&rwlock);
+    stopLog();
+
+    double runTime = elapsedSeconds(startTime, endTime);
+    double commitTotal = 0.0;
+    double commitMax = 0.0;
+    long commitCount = 0;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        commitTotal += threadCounters[i].commitTotal;
+        commitCount += threadCounters[i].commitCount;
+        if (threadCounters[i].commitMax > commitMax)
+            commitMax = threadCounters[i].commitMax;
+    }
+
+    long batches = wal.batchCount - batchesBefore;
+
+    printf ("Time : %f\n", runTime);
+    printf ("Throughput : %f\n", m / runTime);
+    printf ("Commits : %ld\n", commitCount);
+    printf ("Commits per Second : %f\n", commitCount / runTime);
+    printf ("Commit Latency (us) : %f\n", commitCount > 0 ? commitTotal / commitCount * 1e6 : 0.0);
+    printf ("Max Commit Latency (us) : %f\n", commitMax * 1e6);
+    printf ("Batches : %ld\n", batches);
+    printf ("Mean Batch Size : %f\n", batches > 0 ? (double) commitCount / batches : 0.0);
+    printf ("Syncs : %ld\n", wal.syncCount);
+
+    deleteLinkedList(&head);
+    free(threadHandler);
+    free(threadID);
+
+    return 0;
+}
+
+int member (int value, struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+
+    while (curr_p != NULL && curr_p->data < value)
+        curr_p = curr_p->next;
+
+    if (curr_p == NULL || curr_p->data > value)
+    {
+        return 0;
+    }
+    else
+    {
+       return 1;
+    }
+
+};
+
+int insert (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+    struct list_node_s* temp_p;
+
+    while (curr_p != NULL && curr_p->data <value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p == NULL || curr_p->data >value)
+    {
+        temp_p = malloc(sizeof(struct list_node_s));
+        temp_p->data = value;
+        temp_p->next = curr_p;
+
+        if (pred_p == NULL)
+            *head_pp = temp_p;
+        else
+            pred_p->next = temp_p;
+
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+int delete (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p != NULL && curr_p->data == value)
+    {
+        if (pred_p == NULL)
+        {
+            *head_pp = curr_p->next;
+            free(curr_p);
+        }
+        else
+        {
+            pred_p->next = curr_p->next;
+            free(curr_p);
+        }
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+// opens the log and replays it into the list, returns the number of records
+// applied; anything after the last complete and valid record is cut off
+long recoverLog ()
+{
+    struct log_record_s record;
+    long recovered = 0;
+
+    wal.fd = open(logPath, O_RDWR | O_CREAT | (truncateLog ? O_TRUNC : 0), 0644);
+    if (wal.fd < 0)
+    {
+        perror(logPath);
+        exit(1);
+    }
+
+    while (read(wal.fd, &record, sizeof(record)) == sizeof(record)
+           && record.checksum == recordChecksum(record.operation, record.value))
+    {
+        if (record.operation == INSERT)
+            insert(record.value, &head);
+        else if (record.operation == DELETE)
+            delete(record.value, &head);
+
+        recovered++;
+    }
+
+    // new records go right after the last valid one
+    if (ftruncate(wal.fd, recovered * sizeof(record)) != 0 || lseek(wal.fd, 0, SEEK_END) < 0)
+    {
+        perror(logPath);
+        exit(1);
+    }
+
+    return recovered;
+}
+
+// replaces the log with one insert per node of the list, returns the number
+// of records; the new log is synced before it is renamed over the old one
+// whatever the sync policy, since the old log is gone after the rename
+long checkpointLog ()
+{
+    char tempPath[4096];
+    struct log_record_s *records = malloc(sizeof(struct log_record_s) * LOG_BUFFER_RECORDS);
+    int recordCount = 0;
+    long checkpointed = 0;
+
+    snprintf(tempPath, sizeof(tempPath), "%s.checkpoint", logPath);
+    close(wal.fd);
+
+    // the records go through the same write and sync as the flusher's
+    wal.fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (wal.fd < 0)
+    {
+        perror(tempPath);
+        exit(1);
+    }
+
+    for (struct list_node_s *curr_p = head; curr_p != NULL; curr_p = curr_p->next)
+    {
+        records[recordCount] = (struct log_record_s) { INSERT, curr_p->data, recordChecksum(INSERT, curr_p->data) };
+
+        if (++recordCount == LOG_BUFFER_RECORDS)
+        {
+            writeLog(records, recordCount);
+            recordCount = 0;
+        }
+        checkpointed++;
+    }
+    writeLog(records, recordCount);
+    syncLog();
+    free(records);
+
+    // the descriptor stays open on the renamed file, at its end
+    if (rename(tempPath, logPath) != 0)
+    {
+        perror(logPath);
+        exit(1);
+    }
+    syncDirectory();
+
+    return checkpointed;
+}
+
+// syncs the directory holding the log so that the rename itself is durable
+void syncDirectory ()
+{
+    char path[4096];
+
+    snprintf(path, sizeof(path), "%s", logPath);
+    int fd = open(dirname(path), O_RDONLY | O_DIRECTORY);
+
+    if (fd < 0 || fsync(fd) != 0)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    close(fd);
+}
+
+void startLog ()
+{
+    wal.active = malloc(sizeof(struct log_record_s) * LOG_BUFFER_RECORDS);
+    wal.flushing = malloc(sizeof(struct log_record_s) * LOG_BUFFER_RECORDS);
+    wal.activeCount = 0;
+    wal.appendedLsn = 0;
+    wal.durableLsn = 0;
+    wal.stop = 0;
+
+    pthread_mutex_init(&wal.mutex, NULL);
+    pthread_cond_init(&wal.flushNeeded, NULL);
+    pthread_cond_init(&wal.flushDone, NULL);
+    pthread_create(&wal.flusher, NULL, (void *) flusherExecute, NULL);
+}
+
+// flushes what is left, syncs once more and closes the log
+void stopLog ()
+{
+    pthread_mutex_lock(&wal.mutex);
+    wal.stop = 1;
+    pthread_cond_signal(&wal.flushNeeded);
+    pthread_mutex_unlock(&wal.mutex);
+
+    pthread_join(wal.flusher, NULL);
+
+    if (syncPolicy != SYNC_NONE)
+    {
+        syncLog();
+        wal.syncCount++;
+    }
+    close(wal.fd);
+
+    pthread_mutex_destroy(&wal.mutex);
+    pthread_cond_destroy(&wal.flushNeeded);
+    pthread_cond_destroy(&wal.flushDone);
+    free(wal.active);
+    free(wal.flushing);
+}
+
+// adds a record to the active buffer and returns its sequence number,
+// waiting for the flusher when the buffer is full
+long appendLog (int operation, int value)
+{
+    pthread_mutex_lock(&wal.mutex);
+
+    while (wal.activeCount == LOG_BUFFER_RECORDS)
+        pthread_cond_wait(&wal.flushDone, &wal.mutex);
+
+    struct log_record_s *record = &wal.active[wal.activeCount++];
+    record->operation = operation;
+    record->value = value;
+    record->checksum = recordChecksum(operation, value);
+
+    long lsn = ++wal.appendedLsn;
+
+    pthread_cond_signal(&wal.flushNeeded);
+    pthread_mutex_unlock(&wal.mutex);
+
+    return lsn;
+}
+
+// blocks until the record with the given sequence number is committed
+void waitDurable (long lsn)
+{
+    pthread_mutex_lock(&wal.mutex);
+
+    while (wal.durableLsn < lsn)
+        pthread_cond_wait(&wal.flushDone, &wal.mutex);
+
+    pthread_mutex_unlock(&wal.mutex);
+}
+
+// writes out whole batches: every record appended since the last batch goes
+// out with a single write and, depending on the policy, a single sync
+void *flusherExecute ()
+{
+    struct timespec lastSync, now;
+    int unsynced = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &lastSync);
+    pthread_mutex_lock(&wal.mutex);
+
+    while (1)
+    {
+        while (wal.activeCount == 0 && !wal.stop)
+        {
+            if (syncPolicy == SYNC_INTERVAL && unsynced)
+            {
+                // wake up in time to sync the records already written
+                struct timespec deadline;
+                clock_gettime(CLOCK_REALTIME, &deadline);
+                deadline.tv_nsec += syncInterval * 1000000L;
+                deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+                deadline.tv_nsec %= 1000000000L;
+
+                if (pthread_cond_timedwait(&wal.flushNeeded, &wal.mutex, &deadline) != 0)
+                    break;
+            }
+            else
+            {
+                pthread_cond_wait(&wal.flushNeeded, &wal.mutex);
+            }
+        }
+
+        if (wal.activeCount == 0 && wal.stop)
+            break;
+
+        // take the filled buffer and leave the empty one to the workers
+        struct log_record_s *batch = wal.active;
+        int batchCount = wal.activeCount;
+        long batchLsn = wal.appendedLsn;
+
+        wal.active = wal.flushing;
+        wal.flushing = batch;
+        wal.activeCount = 0;
+
+        pthread_mutex_unlock(&wal.mutex);
+
+        writeLog(batch, batchCount);
+        unsynced |= batchCount > 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (unsynced && (syncPolicy == SYNC_BATCH
+            || (syncPolicy == SYNC_INTERVAL && elapsedSeconds(lastSync, now) * 1000 >= syncInterval)))
+        {
+            syncLog();
+            lastSync = now;
+            unsynced = 0;
+            wal.syncCount++;
+        }
+
+        pthread_mutex_lock(&wal.mutex);
+
+        if (batchCount > 0)
+        {
+            wal.durableLsn = batchLsn;
+            wal.batchCount++;
+        }
+        pthread_cond_broadcast(&wal.flushDone);
+    }
+
+    pthread_mutex_unlock(&wal.mutex);
+    return NULL;
+}
+
+// writes the records to the end of the log, continuing after short writes
+void writeLog (struct log_record_s *records, int recordCount)
+{
+    char *data = (char *) records;
+    size_t remaining = sizeof(struct log_record_s) * recordCount;
+
+    while (remaining > 0)
+    {
+        ssize_t written = write(wal.fd, data, remaining);
+
+        if (written < 0)
+        {
+            perror(logPath);
+            exit(1);
+        }
+        data += written;
+        remaining -= written;
+    }
+}
+
+// a record whose sync failed may be lost, so it can never be committed
+void syncLog ()
+{
+    if (fdatasync(wal.fd) != 0)
+    {
+        perror(logPath);
+        exit(1);
+    }
+}
+
+unsigned int recordChecksum (int operation, int value)
+{
+    return LOG_CHECKSUM_SEED ^ ((unsigned int) operation << 24) ^ (unsigned int) value * 2654435761u;
+}
+
+void getArgs (int argc, char *argv[])
+{
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "s:i:t")) != -1)
+    {
+        if (option == 's' && strcmp(optarg, "none") == 0)
+            syncPolicy = SYNC_NONE;
+        else if (option == 's' && strcmp(optarg, "interval") == 0)
+            syncPolicy = SYNC_INTERVAL;
+        else if (option == 's' && strcmp(optarg, "batch") == 0)
+            syncPolicy = SYNC_BATCH;
+        else if (option == 'i')
+            syncInterval = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 't')
+            truncateLog = 1;
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 7)
+    {
+        printf("Enter LinkedListWithWAL [-s none|interval|batch] [-i <syncInterval>] [-t] <logFile> <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+        exit(0);
+    }
+
+    argv += optind - 1;     // positional arguments follow the options
+
+    logPath = argv[1];
+    n = (int) strtol(argv[2], (char **) NULL, 10);
+    m = (int) strtol(argv[3], (char **) NULL, 10);
+    threadCount = (int) strtol(argv[4], (char **) NULL, 10);
+
+    mMemberFrac = (float) atof(argv[5]);
+    mInsertFrac = (float) atof(argv[6]);
+    mDeleteFrac = (float) atof(argv[7]);
+
+    // validating thread count
+    if (threadCount <= 0 || threadCount > MAX_THREAD_COUNT)
+    {
+        printf ("Thread count is incorrect \n");
+        exit(0);
+    }
+
+    if (syncInterval <= 0)
+    {
+        printf ("Sync interval should be positive \n");
+        exit(0);
+    }
+
+    // arg validation
+    if (n <= 0 || m <= 0 || fabsf(mMemberFrac + mInsertFrac + mDeleteFrac - 1.0f) > 1e-5)
+    {
+        printf ("Please give the command with the arguments: ./LinkedListWithWAL <logFile> <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+
+        if (n <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+
+        if (m <= 0)
+            printf ("Value you entered for m is incorrect! \n");
+
+        if (fabsf(mMemberFrac + mInsertFrac + mDeleteFrac - 1.0f) > 1e-5)
+            printf ("mMember + mInsert + mDelete should equals to 1 \n");
+
+        exit(0);
+    }
+};
+
+void* threadExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+    struct thread_counter_s *counter = &threadCounters[id];
+
+    // generate local no of operations without loss
+    int localMemberCount = generateLocalNumberOfOperations(mMember, threadCount, id);
+    int localInsertCount = generateLocalNumberOfOperations(mInsert, threadCount, id);
+    int localDeleteCount = generateLocalNumberOfOperations(mDelete, threadCount, id);
+
+    int local_m = localMemberCount + localInsertCount + localDeleteCount;
+
+    int totalCount = 0;
+    int memberCount = 0;
+    int insertCount = 0;
+    int deleteCount = 0;
+
+    while(totalCount < local_m)
+    {
+        int randomValue = rand() % MAX_RANDOM_NUMBER;   //generate random number for operations
+        int randomOperation = rand() % 3;  //generate random operation type
+
+        if(randomOperation == MEMBER && memberCount < localMemberCount)
+        {
+            pthread_rwlock_rdlock(&rwlock);
+            member(randomValue, head);
+            pthread_rwlock_unlock(&rwlock);
+            memberCount++;
+        }
+        else if((randomOperation == INSERT && insertCount < localInsertCount)
+                || (randomOperation == DELETE && deleteCount < localDeleteCount))
+        {
+            struct timespec startTime, endTime;
+            long lsn = 0;
+
+            clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+            // only operations that changed the list are logged
+            pthread_rwlock_wrlock(&rwlock);
+            if (randomOperation == INSERT ? insert(randomValue, &head) : delete(randomValue, &head))
+                lsn = appendLog(randomOperation, randomValue);
+            pthread_rwlock_unlock(&rwlock);
+
+            if (lsn > 0)
+            {
+                waitDurable(lsn);
+                clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+                double latency = elapsedSeconds(startTime, endTime);
+                counter->commitTotal += latency;
+                counter->commitCount++;
+                if (latency > counter->commitMax)
+                    counter->commitMax = latency;
+            }
+
+            if (randomOperation == INSERT)
+                insertCount++;
+            else
+                deleteCount++;
+        }
+
+        totalCount = memberCount + insertCount + deleteCount;
+    }
+    return NULL;
+}
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime)
+{
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void deleteLinkedList (struct list_node_s** head_pp)
+{
+   struct list_node_s* current = *head_pp;
+   struct list_node_s* next;
+
+   while (current != NULL)
+   {
+       next = current->next;
+       free(current);
+       current = next;
+   }
+
+   *head_pp = NULL;
+}
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id)
+{
+    int localOperationCount = 0;
+
+    if (noOfOperations % threadCount == 0|| noOfOperations % threadCount <= id)
+    {
+        localOperationCount = noOfOperations / threadCount;
+    }
+    else if (noOfOperations % threadCount > id)
+    {
+        localOperationCount = noOfOperations / threadCount + 1;
+    }
+
+    return localOperationCount;
+}
@@ -0,0 +1,645 @@
+/*
+* PersistentLinkedList
+*
+* The sorted set is kept in a pointer-free image file: a small header followed
+* by the keys as a sorted int array. On startup the image is opened with mmap
+* instead of rebuilding the list, and member does a binary search over it.
+* Inserts and deletes go to in-memory overlay lists (new keys and tombstones of
+* image keys) which are merged into a fresh image every <compactInterval>
+* writes and once more before exit. A compaction holds the write lock, so it
+* stalls every thread; the time the run spent in compactions is reported
+* separately, together with the throughput without it.
+*
+* When <imageFile> does not exist it is generated with n random keys from
+* [0, maxKey) first. The key range is stored in the image, so an existing
+* image keeps the range it was generated with and -k and n only apply to a
+* new one.
+*
+* Compile: gcc -g -Wall -o PersistentLinkedList PersistentLinkedList.c -lpthread -lm
+* Run : PersistentLinkedList [-c <compactInterval>] [-k <maxKey>] <imageFile> <n> <m> <threadCount> <mMember> <mIsert> <mDelete>
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libgen.h>
+#include <math.h>
+
+#define MAX_THREAD_COUNT 1024
+#define MEMBER 0
+#define INSERT 1
+#define DELETE 2
+#define IMAGE_MAGIC "LLIMAGE2"
+
+int n; // number of keys generated into a new image
+int m; // number of random operations in the linked list
+int threadCount = 0;
+int maxKey = 65535;         // keys are drawn from [0, maxKey), taken from an existing image
+int compactInterval = 10000;    // overlay writes between compactions
+char *imagePath;
+
+// Fractions of each operations
+float mMemberFrac, mInsertFrac, mDeleteFrac;
+
+// operations count
+float mMember = 0;
+float mInsert = 0;
+float mDelete = 0;
+
+// node definition
+struct list_node_s
+{
+    int data;
+    struct list_node_s *next;
+};
+
+// header of the image file, the sorted keys follow it
+struct image_header_s
+{
+    char magic[8];
+    long keyCount;
+    int maxKey;         // keys of the image and of the workload are in [0, maxKey)
+};
+
+// the image currently mapped into memory
+struct list_image_s
+{
+    void *mapping;
+    size_t size;
+    int *keys;
+    long keyCount;
+};
+
+struct list_image_s image;
+struct list_node_s *insertedHead = NULL;    // keys not in the image
+struct list_node_s *deletedHead = NULL;     // image keys that were deleted
+int pendingWrites = 0;      // overlay writes since the last compaction
+int compactionCount = 0;
+double compactionTime = 0.0;
+pthread_rwlock_t rwlock;
+
+int member (int value, struct list_node_s* head_p);
+
+int insert (int value, struct list_node_s** head_pp);
+
+int delete (int value, struct list_node_s** head_pp);
+
+int imageContains (int value);
+
+int setMember (int value);
+
+int setInsert (int value);
+
+int setDelete (int value);
+
+void generateImage ();
+
+void openImage ();
+
+void compactImage ();
+
+void countOverlayWrite ();
+
+FILE *beginImage (char *tempPath);
+
+void syncDirectory ();
+
+void finishImage (FILE *file, char *tempPath, long keyCount);
+
+void getArgs (int argc, char *argv[]);
+
+void *threadExecute (void *id);
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime);
+
+void deleteLinkedList (struct list_node_s** head_pp);
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id);
+
+int main (int argc, char *argv[])
+{
+    struct timespec startTime, endTime;
+
+    getArgs(argc, argv);
+    mMember = mMemberFrac * m;
+    mInsert = mInsertFrac * m;
+    mDelete = mDeleteFrac * m;
+
+    // startup: reopen the image, generating it first when there is none
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    int generated = access(imagePath, F_OK) != 0;
+    if (generated)
+    {
+        if (n > maxKey)
+        {
+            printf ("n should be at most max key to generate an image \n");
+            exit(0);
+        }
+
+        generateImage();
+    }
+
+    openImage();
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    printf ("Startup (%s) : %f\n", generated ? "generate" : "mmap", elapsedSeconds(startTime, endTime));
+    printf ("Image Keys : %ld\n", image.keyCount);
+    printf ("Max Key : %d\n", maxKey);
+
+    // the first query pays for faulting in the pages it touches
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+    setMember(rand() % maxKey);
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    printf ("First Query Latency (us) : %f\n", elapsedSeconds(startTime, endTime) * 1e6);
+
+    pthread_t* threadHandler = malloc(sizeof(pthread_t)* threadCount);
+    int *threadID = (int *)malloc(sizeof(int) * threadCount);
+
+    pthread_rwlock_init(&rwlock, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        threadID[i] = i;
+        pthread_create(&threadHandler[i], NULL, (void *) threadExecute, (void *) &threadID[i]);
+    }
+
+    for (int i = 0; i < threadCount; i++)
+        pthread_join(threadHandler[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    pthread_rwlock_destroy(&rwlock);
+
+    double runTime = elapsedSeconds(startTime, endTime);
+    double runCompactionTime = compactionTime;     // the final compaction below is not part of the run
+    printf ("Time : %f\n", runTime);
+    printf ("Throughput : %f\n", m / runTime);
+    printf ("Compactions In Run : %d\n", compactionCount);
+    printf ("Compaction Time In Run : %f\n", runCompactionTime);
+    printf ("Throughput Without Compaction : %f\n", m / (runTime - runCompactionTime));
+
+    // the overlay is merged into the image so the next start sees it
+    if (insertedHead != NULL || deletedHead != NULL)
+        compactImage();
+
+    printf ("Compactions : %d\n", compactionCount);
+    printf ("Compaction Time : %f\n", compactionTime);
+
+    munmap(image.mapping, image.size);
+    free(threadHandler);
+    free(threadID);
+
+    return 0;
+}
+
+int member (int value, struct list_node_s* head_p)
+{
+    struct list_node_s* curr_p = head_p;
+
+    while (curr_p != NULL && curr_p->data < value)
+        curr_p = curr_p->next;
+
+    if (curr_p == NULL || curr_p->data > value)
+    {
+        return 0;
+    }
+    else
+    {
+       return 1;
+    }
+
+};
+
+int insert (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+    struct list_node_s* temp_p;
+
+    while (curr_p != NULL && curr_p->data <value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p == NULL || curr_p->data >value)
+    {
+        temp_p = malloc(sizeof(struct list_node_s));
+        temp_p->data = value;
+        temp_p->next = curr_p;
+
+        if (pred_p == NULL)
+            *head_pp = temp_p;
+        else
+            pred_p->next = temp_p;
+
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+int delete (int value, struct list_node_s** head_pp)
+{
+    struct list_node_s* curr_p = *head_pp;
+    struct list_node_s* pred_p = NULL;
+
+    while (curr_p != NULL && curr_p->data < value)
+    {
+        pred_p = curr_p;
+        curr_p = curr_p->next;
+    }
+
+    if (curr_p != NULL && curr_p->data == value)
+    {
+        if (pred_p == NULL)
+        {
+            *head_pp = curr_p->next;
+            free(curr_p);
+        }
+        else
+        {
+            pred_p->next = curr_p->next;
+            free(curr_p);
+        }
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+};
+
+// binary search over the mapped keys
+int imageContains (int value)
+{
+    long low = 0;
+    long high = image.keyCount - 1;
+
+    while (low <= high)
+    {
+        long middle = low + (high - low) / 2;
+
+        if (image.keys[middle] < value)
+            low = middle + 1;
+        else if (image.keys[middle] > value)
+            high = middle - 1;
+        else
+            return 1;
+    }
+
+    return 0;
+}
+
+// the set is the image keys without the tombstones, plus the inserted keys
+int setMember (int value)
+{
+    if (member(value, insertedHead))
+        return 1;
+
+    return imageContains(value) && !member(value, deletedHead);
+}
+
+int setInsert (int value)
+{
+    if (imageContains(value))
+        return delete(value, &deletedHead);     // only a deleted image key can come back
+
+    return insert(value, &insertedHead);
+}
+
+int setDelete (int value)
+{
+    if (delete(value, &insertedHead))
+        return 1;
+
+    return imageContains(value) && insert(value, &deletedHead);
+}
+
+// writes an image of n distinct random keys, selected in ascending order
+// so that multi-million key images do not need a sorted insert per key
+void generateImage ()
+{
+    char tempPath[4096];
+    FILE *file = beginImage(tempPath);
+    long needed = n;
+
+    for (int key = 0; key < maxKey && needed > 0; key++)
+    {
+        // each remaining key is selected with probability needed / remaining
+        if ((double) rand() / ((double) RAND_MAX + 1) * (maxKey - key) < needed)
+        {
+            fwrite(&key, sizeof(int), 1, file);
+            needed--;
+        }
+    }
+
+    finishImage(file, tempPath, n);
+}
+
+void openImage ()
+{
+    struct stat status;
+    int fd = open(imagePath, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &status) != 0)
+    {
+        perror(imagePath);
+        exit(1);
+    }
+
+    image.size = status.st_size;
+    image.mapping = mmap(NULL, image.size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (image.mapping == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+
+    struct image_header_s *header = image.mapping;
+
+    if (image.size < sizeof(struct image_header_s) || memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0
+        || image.size != sizeof(struct image_header_s) + header->keyCount * sizeof(int) || header->maxKey <= 0)
+    {
+        printf ("%s is not a list image \n", imagePath);
+        exit(1);
+    }
+
+    image.keyCount = header->keyCount;
+    image.keys = (int *) (header + 1);
+    maxKey = header->maxKey;
+}
+
+// merges the overlay into a new image and maps it in place of the old one,
+// called with the write lock held
+void compactImage ()
+{
+    struct timespec startTime, endTime;
+    char tempPath[4096];
+    long keyCount = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &startTime);
+
+    FILE *file = beginImage(tempPath);
+    struct list_node_s *inserted_p = insertedHead;
+    struct list_node_s *deleted_p = deletedHead;
+
+    for (long i = 0; i <= image.keyCount; i++)
+    {
+        // inserted keys that sort before the next image key go first
+        while (inserted_p != NULL && (i == image.keyCount || inserted_p->data < image.keys[i]))
+        {
+            fwrite(&inserted_p->data, sizeof(int), 1, file);
+            keyCount++;
+            inserted_p = inserted_p->next;
+        }
+
+        if (i == image.keyCount)
+            break;
+
+        if (deleted_p != NULL && deleted_p->data == image.keys[i])
+        {
+            deleted_p = deleted_p->next;
+            continue;
+        }
+
+        fwrite(&image.keys[i], sizeof(int), 1, file);
+        keyCount++;
+    }
+
+    finishImage(file, tempPath, keyCount);
+
+    munmap(image.mapping, image.size);
+    openImage();
+
+    deleteLinkedList(&insertedHead);
+    deleteLinkedList(&deletedHead);
+    pendingWrites = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &endTime);
+
+    compactionCount++;
+    compactionTime += elapsedSeconds(startTime, endTime);
+}
+
+// compacts once enough writes went to the overlay, called with the write lock held
+void countOverlayWrite ()
+{
+    if (++pendingWrites >= compactInterval)
+        compactImage();
+}
+
+// opens a temporary image next to the real one, the keys are written after the header
+FILE *beginImage (char *tempPath)
+{
+    struct image_header_s header = { IMAGE_MAGIC, 0, maxKey };
+
+    snprintf(tempPath, 4096, "%s.tmp", imagePath);
+    FILE *file = fopen(tempPath, "wb");
+
+    if (file == NULL)
+    {
+        perror(tempPath);
+        exit(1);
+    }
+
+    fwrite(&header, sizeof(header), 1, file);
+    return file;
+}
+
+// fills in the key count, syncs the file and renames it over the real image
+void finishImage (FILE *file, char *tempPath, long keyCount)
+{
+    struct image_header_s header = { IMAGE_MAGIC, keyCount, maxKey };
+
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0 || fclose(file) != 0 || rename(tempPath, imagePath) != 0)
+    {
+        perror(imagePath);
+        exit(1);
+    }
+
+    syncDirectory();
+}
+
+// syncs the directory holding the image so that the rename itself is durable
+void syncDirectory ()
+{
+    char path[4096];
+
+    snprintf(path, sizeof(path), "%s", imagePath);
+    int fd = open(dirname(path), O_RDONLY | O_DIRECTORY);
+
+    if (fd < 0 || fsync(fd) != 0)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    close(fd);
+}
+
+void getArgs (int argc, char *argv[])
+{
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "c:k:")) != -1)
+    {
+        if (option == 'c')
+            compactInterval = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 'k')
+            maxKey = (int) strtol(optarg, (char **) NULL, 10);
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 7)
+    {
+        printf("Enter PersistentLinkedList [-c <compactInterval>] [-k <maxKey>] <imageFile> <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+        exit(0);
+    }
+
+    argv += optind - 1;     // positional arguments follow the options
+
+    imagePath = argv[1];
+    n = (int) strtol(argv[2], (char **) NULL, 10);
+    m = (int) strtol(argv[3], (char **) NULL, 10);
+    threadCount = (int) strtol(argv[4], (char **) NULL, 10);
+
+    mMemberFrac = (float) atof(argv[5]);
+    mInsertFrac = (float) atof(argv[6]);
+    mDeleteFrac = (float) atof(argv[7]);
+
+    // validating thread count
+    if (threadCount <= 0 || threadCount > MAX_THREAD_COUNT)
+    {
+        printf ("Thread count is incorrect \n");
+        exit(0);
+    }
+
+    if (compactInterval <= 0 || maxKey <= 0)
+    {
+        printf ("Compaction interval and max key should be positive \n");
+        exit(0);
+    }
+
+    // arg validation
+    if (n <= 0 || m <= 0 || fabsf(mMemberFrac + mInsertFrac + mDeleteFrac - 1.0f) > 1e-5)
+    {
+        printf ("Please give the command with the arguments: ./PersistentLinkedList <imageFile> <n> <m> <threadCount> <mMember> <mInsert> <mDelete> \n");
+
+        if (n <= 0)
+            printf ("Value you entered for n is incorrect! \n");
+
+        if (m <= 0)
+            printf ("Value you entered for m is incorrect! \n");
+
+        if (fabsf(mMemberFrac + mInsertFrac + mDeleteFrac - 1.0f) > 1e-5)
+            printf ("mMember + mInsert + mDelete should equals to 1 \n");
+
+        exit(0);
+    }
+};
+
+void* threadExecute(void* thread_id)
+{
+    int id = *(int *) thread_id;
+
+    // generate local no of operations without loss
+    int localMemberCount = generateLocalNumberOfOperations(mMember, threadCount, id);
+    int localInsertCount = generateLocalNumberOfOperations(mInsert, threadCount, id);
+    int localDeleteCount = generateLocalNumberOfOperations(mDelete, threadCount, id);
+
+    int local_m = localMemberCount + localInsertCount + localDeleteCount;
+
+    int totalCount = 0;
+    int memberCount = 0;
+    int insertCount = 0;
+    int deleteCount = 0;
+
+    while(totalCount < local_m)
+    {
+        int randomValue = rand() % maxKey;   //generate random number for operations
+        int randomOperation = rand() % 3;  //generate random operation type
+
+        if(randomOperation == MEMBER && memberCount < localMemberCount)
+        {
+            pthread_rwlock_rdlock(&rwlock);
+            setMember(randomValue);
+            pthread_rwlock_unlock(&rwlock);
+            memberCount++;
+        }
+        else if(randomOperation == INSERT && insertCount < localInsertCount)
+        {
+            pthread_rwlock_wrlock(&rwlock);
+            if (setInsert(randomValue))
+                countOverlayWrite();
+            pthread_rwlock_unlock(&rwlock);
+            insertCount++;
+        }
+        else if(randomOperation == DELETE && deleteCount < localDeleteCount)
+        {
+            pthread_rwlock_wrlock(&rwlock);
+            if (setDelete(randomValue))
+                countOverlayWrite();
+            pthread_rwlock_unlock(&rwlock);
+            deleteCount++;
+        }
+
+        totalCount = memberCount + insertCount + deleteCount;
+    }
+    return NULL;
+}
+
+double elapsedSeconds (struct timespec startTime, struct timespec endTime)
+{
+    return (endTime.tv_sec - startTime.tv_sec) + (endTime.tv_nsec - startTime.tv_nsec) / 1e9;
+}
+
+void deleteLinkedList (struct list_node_s** head_pp)
+{
+   struct list_node_s* current = *head_pp;
+   struct list_node_s* next;
+
+   while (current != NULL)
+   {
+       next = current->next;
+       free(current);
+       current = next;
+   }
+
+   *head_pp = NULL;
+}
+
+int generateLocalNumberOfOperations (int noOfOperations, int threadCount, int id)
+{
+    int localOperationCount = 0;
+
+    if (noOfOperations % threadCount == 0|| noOfOperations % threadCount <= id)
+    {
+        localOperationCount = noOfOperations / threadCount;
+    }
+    else if (noOfOperations % threadCount > id)
+    {
+        localOperationCount = noOfOperations / threadCount + 1;
+    }
+
+    return localOperationCount;
+}
@@ -1,8 +1,30 @@
 /*
 * SeriaLinkedList 
 *
-* Compile: gcc -g -Wall -o SerialLinkedList SerialLinkedList.c
-* Run : SerialLinkedList <n> <m> <mMember> <mIsert> <mDelete>
+* Compile: gcc -g -Wall -o SerialLinkedList SerialLinkedList.c -lm
+* Run : SerialLinkedList [-p] [-a malloc|pool|huge] [-P] [-D <defragInterval>] [-k <maxKey>] [-s <sampleSize>]
+*       <n> <m> <mMember> <mIsert> <mDelete>
+*
+* With -p hardware events are counted around the timed region of each sample
+* (see perfCounters.h) and reported per operation after Mean/STD.
+*
+* By default the list is built by inserting n random keys one by one, as it
+* always was, so that plain runs stay comparable with earlier results. With
+* -a pool|huge, -k or -D it is built directly in key order from n distinct
+* keys in [0, maxKey), with the nodes placed in memory in random order, as if
+* they had been inserted one by one. Nodes come from:
+*
+*   malloc - one malloc per node
+*   pool   - a node pool in one mapping of 4 KB pages
+*   huge   - a node pool on 2 MB pages: hugetlbfs, or transparent huge pages
+*            through madvise when no huge pages are reserved, or 4 KB pages
+*
+* With -P the traversals in member, insert and delete prefetch next->next.
+* With -D the list is copied into a second pool in key order every
+* <defragInterval> operations, so that a traversal walks memory forwards; the
+* time spent on it is part of the timed region and is also reported alone.
+* The list is first relinked after <defragInterval> operations, never before
+* the first one or after the last one.
 *
 */
 
@@ -10,18 +32,34 @@
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "perfCounters.h"
 
 #define MAX_RANDOM_NUMBER 65535
 #define MEMBER 0
 #define INSERT 1
 #define DELETE 2
+#define ALLOCATOR_MALLOC 0
+#define ALLOCATOR_POOL 1
+#define ALLOCATOR_HUGE 2
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
 
 int n;      // number of nodes in the linked list
 int m;      // number of random operations for the linked list
 int sampleSize = 385;    // number of samples considered
+int collectPerfCounters = 0;    // count hardware events around each sample
+int maxKey = MAX_RANDOM_NUMBER; // keys are drawn from [0, maxKey)
+int allocator = ALLOCATOR_MALLOC;
+int controlledLayout = 0;   // build the list with buildLinkedList, set by -a pool|huge, -k and -D
+int prefetchNodes = 0;  // prefetch next->next while traversing
+int defragInterval = 0; // operations between two relinks in key order, 0 never
 
 float mMemberFrac, mInsertFrac, mDeleteFrac;    // Fractions of the operations
 
+struct perf_counters_s perfTotal;    // summed over all samples
+
 // node definition
 struct list_node_s
 {
@@ -29,6 +67,19 @@ struct list_node_s
     struct list_node_s *next;
 };
 
+// nodes carved from one mapping; freed nodes are reused before new ones
+struct node_pool_s
+{
+    struct list_node_s *nodes;
+    long capacity;
+    long used;          // nodes handed out from the mapping so far
+    struct list_node_s *freeList;
+    const char *backing;
+};
+
+struct node_pool_s pools[2];    // the second one is the target of a defragmentation
+int activePool = 0;
+
 int member (int value, struct list_node_s* head_p);
 
 int insert (int value, struct list_node_s** head_pp);
@@ -41,16 +92,38 @@ void deleteLinkedList (struct list_node_s** head_pp);
 
 float calculateSTD (double data[], float mean);
 
+struct list_node_s *allocateNode ();
+
+void freeNode (struct list_node_s *node);
+
+void initPool (struct node_pool_s *pool, long capacity);
+
+void buildLinkedList (struct list_node_s** head_pp);
+
+void defragment (struct list_node_s** head_pp);
+
 int main (int argc, char *argv[])
 {
     struct list_node_s *head = NULL;
 
+    getArgs(argc, argv);
+
     double timeArray[sampleSize];  // store total time taken for each sample
     double totalTime = 0.0;
+    double defragTime = 0.0;
     float mean= 0.0;
     float std = 0.0;
-    
-    getArgs(argc, argv);
+
+    // a sample never has more than n + m nodes alive
+    if (allocator != ALLOCATOR_MALLOC)
+    {
+        initPool(&pools[0], (long) n + m);
+        if (defragInterval > 0)
+            initPool(&pools[1], (long) n + m);
+
+        printf ("Node Pool : %s\n", pools[0].backing);
+    }
+
     float mMember = mMemberFrac * m;
     float mInsert = mInsertFrac * m;
     float mDelete = mDeleteFrac * m;
@@ -66,17 +139,26 @@ int main (int argc, char *argv[])
         clock_t startTime, endTime;
 
         // Linked list generation with non-repeating random numbers
-        for (int i = 0; i < n; i++)
+        if (controlledLayout)
+            buildLinkedList(&head);
+        else
         {
-            if (!insert(rand() % MAX_RANDOM_NUMBER, &head))
-                i--;
+            for (int i = 0; i < n; i++)
+            {
+                if (!insert(rand() % maxKey, &head))
+                    i--;
+            }
         }
 
+        if (collectPerfCounters)
+            startPerfCounters(&perfTotal);
+
         startTime = clock();
 
         while (totalCount < m)
         {
-            int randomValue = rand() % MAX_RANDOM_NUMBER;   //generate random number for operations
+            int previousCount = totalCount;
+            int randomValue = rand() % maxKey;   //generate random number for operations
             int randomOperation = rand() % 3;      //generate random operation type
         
             if (randomOperation == MEMBER && memberCount < mMember)
@@ -96,9 +178,21 @@ int main (int argc, char *argv[])
             }
 
             totalCount = memberCount + insertCount + deleteCount;
+
+            // only right after an operation ran, and not after the last one
+            if (defragInterval > 0 && totalCount != previousCount && totalCount < m
+                && totalCount % defragInterval == 0)
+            {
+                clock_t defragStart = clock();
+                defragment(&head);
+                defragTime += ((double) (clock() - defragStart)) / CLOCKS_PER_SEC;
+            }
         }
 
         endTime = clock();
+
+        if (collectPerfCounters)
+            stopPerfCounters(&perfTotal);
         
         timeArray[j] = ((double) (endTime - startTime)) / CLOCKS_PER_SEC;
         totalTime += timeArray[j];
@@ -114,6 +208,12 @@ int main (int argc, char *argv[])
     printf ("Mean : %f\n", mean);
     printf ("STD : %f\n", std);
 
+    if (defragInterval > 0)
+        printf ("Defragmentation Time : %f\n", defragTime / sampleSize);
+
+    if (collectPerfCounters)
+        printPerfCounters(&perfTotal, (double) m * sampleSize);
+
     return 0;
     
 }
@@ -123,7 +223,12 @@ int member (int value, struct list_node_s* head_p)
     struct list_node_s* curr_p = head_p;
 
     while (curr_p != NULL && curr_p->data < value)
-        curr_p = curr_p->next; 
+    {
+        // the prefetch has the node after next on its way while next is compared
+        if (prefetchNodes && curr_p->next != NULL)
+            __builtin_prefetch(curr_p->next->next);
+        curr_p = curr_p->next;
+    }
     
     if (curr_p == NULL || curr_p->data > value)
     {
@@ -144,13 +249,15 @@ int insert (int value, struct list_node_s** head_pp)
 
     while (curr_p != NULL && curr_p->data <value)
     {
+        if (prefetchNodes && curr_p->next != NULL)
+            __builtin_prefetch(curr_p->next->next);
         pred_p = curr_p;
         curr_p = curr_p->next;
     }
 
     if (curr_p == NULL || curr_p->data >value)
     {
-        temp_p = malloc(sizeof(struct list_node_s));
+        temp_p = allocateNode();
         temp_p->data = value;
         temp_p->next = curr_p;
 
@@ -174,6 +281,8 @@ int delete (int value, struct list_node_s** head_pp)
 
     while (curr_p != NULL && curr_p->data < value)
     {
+        if (prefetchNodes && curr_p->next != NULL)
+            __builtin_prefetch(curr_p->next->next);
         pred_p = curr_p;
         curr_p = curr_p->next;
     }
@@ -183,12 +292,12 @@ int delete (int value, struct list_node_s** head_pp)
         if (pred_p == NULL)
         {
             *head_pp = curr_p->next;
-            free(curr_p);
+            freeNode(curr_p);
         }
         else
         {
             pred_p->next = curr_p->next;
-            free(curr_p);
+            freeNode(curr_p);
         }
         return 1;   
     }
@@ -200,12 +309,41 @@ int delete (int value, struct list_node_s** head_pp)
 
 void getArgs (int argc, char *argv[])
 {
-    if(argc != 6)
+    int option;
+    int badOption = 0;
+    while ((option = getopt(argc, argv, "pa:PD:k:s:")) != -1)
+    {
+        if (option == 'p')
+            collectPerfCounters = 1;
+        else if (option == 'a' && strcmp(optarg, "malloc") == 0)
+            allocator = ALLOCATOR_MALLOC;
+        else if (option == 'a' && strcmp(optarg, "pool") == 0)
+            allocator = ALLOCATOR_POOL;
+        else if (option == 'a' && strcmp(optarg, "huge") == 0)
+            allocator = ALLOCATOR_HUGE;
+        else if (option == 'P')
+            prefetchNodes = 1;
+        else if (option == 'D')
+            defragInterval = (int) strtol(optarg, (char **) NULL, 10);
+        else if (option == 'k')
+        {
+            maxKey = (int) strtol(optarg, (char **) NULL, 10);
+            controlledLayout = 1;
+        }
+        else if (option == 's')
+            sampleSize = (int) strtol(optarg, (char **) NULL, 10);
+        else
+            badOption = 1;
+    }
+
+    if(badOption || argc - optind != 5)
     {
-        printf("Enter SerialLinked list <n> <m> <mMember> <mInsert> <mDelete> \n");
+        printf("Enter SerialLinked list [-p] [-a malloc|pool|huge] [-P] [-D <defragInterval>] [-k <maxKey>] [-s <sampleSize>] <n> <m> <mMember> <mInsert> <mDelete> \n");
         exit(0);
     }
 
+    argv += optind - 1;     // positional arguments follow the options
+
     n = (int) strtol(argv[1], (char **) NULL, 10);
     m = (int) strtol(argv[2], (char **) NULL, 10);
 
@@ -213,12 +351,27 @@ void getArgs (int argc, char *argv[])
     mInsertFrac = (float) atof(argv[4]);
     mDeleteFrac = (float) atof(argv[5]);
 
+    // validating the layout options
+    controlledLayout |= allocator != ALLOCATOR_MALLOC || defragInterval > 0;
+
+    if (maxKey <= 0 || sampleSize <= 0 || defragInterval < 0)
+    {
+        printf ("Key range, sample size and defragmentation interval should be positive \n");
+        exit(0);
+    }
+
+    if (defragInterval > 0 && allocator == ALLOCATOR_MALLOC)
+    {
+        printf ("Defragmentation relinks nodes inside the node pool, use -a pool or -a huge \n");
+        exit(0);
+    }
+
     // arg validation
-    if (n <= 0 || m <= 0 || mMemberFrac + mInsertFrac + mDeleteFrac != 1.0)
+    if (n <= 0 || n > maxKey || m <= 0 || mMemberFrac + mInsertFrac + mDeleteFrac != 1.0)
     {
         printf ("Please give the command with the arguments: ./serial_linked list <n> <m> <mMember> <mInsert> <mDelete> \n");
 
-        if (n <= 0)
+        if (n <= 0 || n > maxKey)
             printf ("Value you entered for n is incorrect! \n");
         
         if (m <= 0)
@@ -245,6 +398,20 @@ void deleteLinkedList (struct list_node_s** head_pp)
 { 
    struct list_node_s* current = *head_pp; 
    struct list_node_s* next; 
+
+   // pooled nodes go back all at once
+   if (allocator != ALLOCATOR_MALLOC)
+   {
+       for (int i = 0; i < 2; i++)
+       {
+           pools[i].used = 0;
+           pools[i].freeList = NULL;
+       }
+
+       activePool = 0;
+       *head_pp = NULL;
+       return;
+   }
   
    while (current != NULL)  
    { 
@@ -255,3 +422,137 @@ void deleteLinkedList (struct list_node_s** head_pp)
    
    *head_pp = NULL; 
 } 
+
+struct list_node_s *allocateNode ()
+{
+    struct node_pool_s *pool = &pools[activePool];
+    struct list_node_s *node;
+
+    if (allocator == ALLOCATOR_MALLOC)
+        return malloc(sizeof(struct list_node_s));
+
+    if (pool->freeList != NULL)
+    {
+        node = pool->freeList;
+        pool->freeList = node->next;
+    }
+    else if (pool->used < pool->capacity)
+        node = &pool->nodes[pool->used++];
+    else
+    {
+        printf ("Node pool is exhausted \n");
+        exit(1);
+    }
+
+    return node;
+}
+
+void freeNode (struct list_node_s *node)
+{
+    if (allocator == ALLOCATOR_MALLOC)
+    {
+        free(node);
+        return;
+    }
+
+    node->next = pools[activePool].freeList;
+    pools[activePool].freeList = node;
+}
+
+// maps room for <capacity> nodes, rounded up to whole 2 MB pages; huge pages
+// are tried from hugetlbfs first, then from transparent huge pages
+void initPool (struct node_pool_s *pool, long capacity)
+{
+    size_t size = (capacity * sizeof(struct list_node_s) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *mapping = MAP_FAILED;
+
+    pool->backing = "4 KB pages";
+
+    if (allocator == ALLOCATOR_HUGE)
+    {
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping != MAP_FAILED)
+            pool->backing = "hugetlbfs";
+    }
+
+    if (mapping == MAP_FAILED)
+    {
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED)
+        {
+            perror("mmap");
+            exit(1);
+        }
+
+        // the 4 KB pool stays on 4 KB pages even when THP is always on
+        if (allocator == ALLOCATOR_HUGE && madvise(mapping, size, MADV_HUGEPAGE) == 0)
+            pool->backing = "transparent huge pages";
+        else if (allocator == ALLOCATOR_POOL)
+            madvise(mapping, size, MADV_NOHUGEPAGE);
+    }
+
+    pool->nodes = mapping;
+    pool->capacity = size / sizeof(struct list_node_s);
+    pool->used = 0;
+    pool->freeList = NULL;
+}
+
+// builds the list from n distinct keys picked in order by selection sampling;
+// the nodes are shuffled before they are linked so that neighbours in the list
+// are scattered in memory the way random inserts leave them
+void buildLinkedList (struct list_node_s** head_pp)
+{
+    struct list_node_s **nodes = malloc(sizeof(struct list_node_s *) * n);
+    int needed = n;
+    int i = 0;
+
+    for (i = 0; i < n; i++)
+        nodes[i] = allocateNode();
+
+    for (i = n - 1; i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        struct list_node_s *temp_p = nodes[i];
+        nodes[i] = nodes[j];
+        nodes[j] = temp_p;
+    }
+
+    i = 0;
+    for (int key = 0; key < maxKey && needed > 0; key++)
+    {
+        // each remaining key is selected with probability needed / remaining
+        if ((double) rand() / ((double) RAND_MAX + 1) * (maxKey - key) < needed)
+        {
+            nodes[i]->data = key;
+            nodes[i]->next = i + 1 < n ? nodes[i + 1] : NULL;
+            needed--;
+            i++;
+        }
+    }
+
+    *head_pp = n > 0 ? nodes[0] : NULL;
+    free(nodes);
+}
+
+// copies the list into the other pool in key order and makes that pool the
+// active one; the nodes left behind are dropped with the old pool's contents
+void defragment (struct list_node_s** head_pp)
+{
+    struct node_pool_s *target = &pools[1 - activePool];
+    struct list_node_s **tail_pp = head_pp;
+
+    target->used = 0;
+    target->freeList = NULL;
+
+    for (struct list_node_s *curr_p = *head_pp; curr_p != NULL; curr_p = curr_p->next)
+    {
+        struct list_node_s *node = &target->nodes[target->used++];
+
+        node->data = curr_p->data;
+        *tail_pp = node;
+        tail_pp = &node->next;
+    }
+
+    *tail_pp = NULL;
+    activePool = 1 - activePool;
+}
@@ -0,0 +1,44 @@
+#!/bin/sh
+#
+# compareAdaptiveLocking
+#
+# Runs the adaptive list on a phased workload with each locking scheme fixed
+# (-f) and with switching on, and prints time, throughput and the number of
+# switches side by side. <phases> are "<mMember>,<mInsert>,<mDelete>" mixes of
+# m operations each, run in order.
+#
+# Run : ./compareAdaptiveLocking.sh [<phases> <n> <m> <threadCount>]
+#
+
+phases=${1:-"0.99,0.005,0.005 0.2,0.4,0.4 0.99,0.005,0.005"}
+n=${2:-1000}
+m=${3:-50000}
+threadCount=${4:-8}
+
+gcc -O2 -Wall -o LinkedListAdaptive LinkedListAdaptive.c -lpthread -lm || exit 1
+
+# the first phase is positional, every later one is a -p option
+firstPhase=""
+phaseOptions=""
+for phase in $phases
+do
+    if [ -z "$firstPhase" ]
+    then
+        firstPhase=$(echo "$phase" | tr ',' ' ')
+    else
+        phaseOptions="$phaseOptions -p $phase"
+    fi
+done
+
+printf "%-12s %-12s %-16s %-14s %s\n" "Scheme" "Time" "Throughput" "Mode Switches" "Rejected Switches"
+
+for scheme in "mutex -f" "rwlock -f" "fine -f" "mutex"
+do
+    ./LinkedListAdaptive -e $scheme $phaseOptions "$n" "$m" "$threadCount" $firstPhase |
+        awk -F' : ' -v scheme="$scheme" '
+            /^Time :/ { time = $2 }
+            /^Throughput/ { throughput = $2 }
+            /^Mode Switches/ { switches = $2 }
+            /^Rejected Switches/ { rejected = $2 }
+            END { printf "%-12s %-12s %-16s %-14s %s\n", (scheme ~ /-f/ ? scheme : "adaptive"), time, throughput, switches, rejected }'
+done
@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# compareLogSyncPolicies
+#
+# Runs the write-ahead log program with every sync policy on a fresh log in
+# <logDirectory> (e.g. a local disk directory or a tmpfs mount such as
+# /dev/shm) and prints throughput and commit latency side by side.
+#
+# Run : ./compareLogSyncPolicies.sh [<logDirectory> <n> <m> <threadCount> <mMember> <mInsert> <mDelete>]
+#
+
+logDirectory=${1:-.}
+n=${2:-1000}
+m=${3:-10000}
+threadCount=${4:-8}
+mMember=${5:-0.5}
+mInsert=${6:-0.25}
+mDelete=${7:-0.25}
+logFile="$logDirectory/compareLogSyncPolicies.log"
+
+gcc -O2 -Wall -o LinkedListWithWAL LinkedListWithWAL.c -lpthread -lm || exit 1
+
+printf "%-10s %-16s %-22s %-26s %s\n" "Policy" "Throughput" "Commit Latency (us)" "Max Commit Latency (us)" "Mean Batch Size"
+
+for policy in none interval batch
+do
+    ./LinkedListWithWAL -t -s $policy "$logFile" "$n" "$m" "$threadCount" "$mMember" "$mInsert" "$mDelete" |
+        awk -F' : ' -v policy=$policy '
+            /^Throughput/ { throughput = $2 }
+            /^Commit Latency/ { latency = $2 }
+            /^Max Commit Latency/ { maxLatency = $2 }
+            /^Mean Batch Size/ { batchSize = $2 }
+            END { printf "%-10s %-16s %-22s %-26s %s\n", policy, throughput, latency, maxLatency, batchSize }'
+done
+
+rm -f "$logFile"
@@ -0,0 +1,39 @@
+#!/bin/sh
+#
+# compareRequestQueueRatios
+#
+# Runs the request queue program for every producer:consumer pair in
+# <ratios> (e.g. "1:1 4:1 1:4") with blocking and polling completion and
+# prints throughput and end-to-end latency side by side.
+#
+# Run : ./compareRequestQueueRatios.sh [<ratios> <engine> <n> <m> <mMember> <mInsert> <mDelete>]
+#
+
+ratios=${1:-"1:1 2:1 4:1 1:2 1:4 4:4"}
+engine=${2:-mutex}
+n=${3:-1000}
+m=${4:-100000}
+mMember=${5:-0.99}
+mInsert=${6:-0.005}
+mDelete=${7:-0.005}
+
+gcc -O2 -Wall -o LinkedListWithRequestQueue LinkedListWithRequestQueue.c -lpthread -lm || exit 1
+
+printf "%-10s %-10s %-16s %-26s %-30s %s\n" "Ratio" "Completion" "Throughput" "End-to-End Latency (us)" "Max End-to-End Latency (us)" "Mean Batch Size"
+
+for ratio in $ratios
+do
+    producers=${ratio%:*}
+    consumers=${ratio#*:}
+
+    for completion in blocking polling
+    do
+        ./LinkedListWithRequestQueue -e "$engine" -c $completion "$n" "$m" "$producers" "$consumers" "$mMember" "$mInsert" "$mDelete" |
+            awk -F' : ' -v ratio=$ratio -v completion=$completion '
+                /^Throughput/ { throughput = $2 }
+                /^End-to-End Latency/ { latency = $2 }
+                /^Max End-to-End Latency/ { maxLatency = $2 }
+                /^Mean Batch Size/ { batchSize = $2 }
+                END { printf "%-10s %-10s %-16s %-26s %-30s %s\n", ratio, completion, throughput, latency, maxLatency, batchSize }'
+    done
+done
@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+# compareSeqLockWithReadWriteLocks
+#
+# Runs the read-write lock and the seqlock programs in duration mode for
+# 1 to 64 threads and prints the total throughput of both side by side.
+#
+# Run : ./compareSeqLockWithReadWriteLocks.sh [<n> <duration> <mMember> <mInsert> <mDelete>]
+#
+
+n=${1:-1000}
+duration=${2:-2}
+mMember=${3:-0.99}
+mInsert=${4:-0.005}
+mDelete=${5:-0.005}
+
+gcc -O2 -Wall -o LinkedListWithReadWriteLocks LinkedListWithReadWriteLocks.c -lpthread -lm || exit 1
+gcc -O2 -Wall -o LinkedListWithSeqLock LinkedListWithSeqLock.c -lpthread -lm || exit 1
+
+throughput ()
+{
+    ./$1 -d "$duration" -w 0.5 "$n" 1 "$2" "$mMember" "$mInsert" "$mDelete" | awk -F' : ' '/^Total Throughput/ { print $2 }'
+}
+
+printf "%-8s %-18s %-18s %s\n" "Threads" "ReadWriteLocks" "SeqLock" "Speedup"
+
+for threads in 1 2 4 8 16 32 64
+do
+    rwlock=$(throughput LinkedListWithReadWriteLocks $threads)
+    seqlock=$(throughput LinkedListWithSeqLock $threads)
+    speedup=$(awk -v a="$seqlock" -v b="$rwlock" 'BEGIN { printf "%.3f", (b > 0 ? a / b : 0) }')
+
+    printf "%-8s %-18s %-18s %s\n" "$threads" "$rwlock" "$seqlock" "$speedup"
+done
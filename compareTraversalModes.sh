@@ -0,0 +1,43 @@
+#!/bin/sh
+#
+# compareTraversalModes
+#
+# Runs the serial list at each size in <sizes> with the nodes from malloc, a
+# 4 KB page pool and a huge page pool, with and without prefetching and with
+# periodic defragmentation, and prints the mean time per operation. The
+# number of operations is 20000000 / n, at least 20, to bound the work of the
+# long traversals; at the sizes where the floor applies a run takes longer.
+# The key range is four times the list size (at least 65535).
+#
+# Run : ./compareTraversalModes.sh [<sizes> <sampleSize> <mMember> <mInsert> <mDelete>]
+#
+
+sizes=${1:-"1000 100000 10000000"}
+sampleSize=${2:-3}
+mMember=${3:-0.8}
+mInsert=${4:-0.1}
+mDelete=${5:-0.1}
+
+gcc -O2 -Wall -o SerialLinkedList SerialLinkedList.c -lm || exit 1
+
+printf "%-10s %-22s %-24s %-16s %s\n" "n" "Mode" "Node Pool" "STD" "Time per Operation (us)"
+
+for n in $sizes
+do
+    m=$((20000000 / n))
+    [ $m -lt 20 ] && m=20
+    maxKey=$((4 * n))
+    [ $maxKey -lt 65535 ] && maxKey=65535
+    defragInterval=$(( (m + 3) / 4 ))
+
+    for mode in "-a malloc" "-a pool" "-a huge" "-a huge -P" "-a huge -D $defragInterval" "-a huge -P -D $defragInterval"
+    do
+        ./SerialLinkedList $mode -k $maxKey -s $sampleSize "$n" "$m" "$mMember" "$mInsert" "$mDelete" |
+            awk -F' : ' -v n=$n -v m=$m -v mode="$mode" '
+                BEGIN { pool = "malloc" }
+                /^Node Pool/ { pool = $2 }
+                /^Mean/ { mean = $2 }
+                /^STD/ { std = $2 }
+                END { printf "%-10s %-22s %-24s %-16s %f\n", n, mode, pool, std, mean / m * 1e6 }'
+    done
+done
@@ -0,0 +1,148 @@
+/*
+* perfCounters
+*
+* Hardware and software event counters for the calling thread, and for the
+* threads it creates while they are open, through
+* perf_event_open: cycles, instructions, LLC misses, dTLB misses, branch
+* misses and context switches. Every counter is opened on its own, so a
+* counter the kernel or the container refuses (perf_event_paranoid, missing
+* PMU in a VM, seccomp) is simply marked unavailable and the rest still count;
+* when none can be opened everything here is a no-op.
+*
+* Counts are scaled by time enabled / time running when the kernel had to
+* multiplex the counters.
+*
+* Usage: a thread calls startPerfCounters before its work, or before creating
+* the threads that do it, and stopPerfCounters after it (and after joining
+* them). Both can stay outside the timed region: the counts of joined threads
+* are folded into the counters of their creator. The counts are added to the
+* struct, which can be summed over samples with addPerfCounters and reported
+* per operation with printPerfCounters.
+*
+*/
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define PERF_COUNTER_TYPES 6
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+// counters of one thread, or a sum of them, padded to full cache lines
+struct perf_counters_s
+{
+    int fd[PERF_COUNTER_TYPES];
+    int available[PERF_COUNTER_TYPES];  // counter was opened at least once
+    double value[PERF_COUNTER_TYPES];   // scaled counts accumulated so far
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+static const char *perfCounterNames[PERF_COUNTER_TYPES] =
+{
+    "Cycles", "Instructions", "LLC Misses", "dTLB Misses", "Branch Misses", "Context Switches"
+};
+
+static const unsigned int perfCounterTypes[PERF_COUNTER_TYPES] =
+{
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+    PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+};
+
+static const unsigned long long perfCounterConfigs[PERF_COUNTER_TYPES] =
+{
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_SW_CONTEXT_SWITCHES
+};
+
+// opens and enables the counters for the calling thread and the threads it
+// creates from now on, on any CPU
+static inline void startPerfCounters (struct perf_counters_s *counters)
+{
+    struct perf_event_attr attr;
+
+    for (int i = 0; i < PERF_COUNTER_TYPES; i++)
+    {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = perfCounterTypes[i];
+        attr.config = perfCounterConfigs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // context switches are only visible with the kernel included
+        if (attr.type == PERF_TYPE_SOFTWARE)
+            attr.exclude_kernel = 0;
+
+        counters->fd[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+        if (counters->fd[i] >= 0)
+        {
+            counters->available[i] = 1;
+            ioctl(counters->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+// disables the counters of the calling thread, adds their counts and closes them
+static inline void stopPerfCounters (struct perf_counters_s *counters)
+{
+    unsigned long long reading[3];  // value, time enabled, time running
+
+    for (int i = 0; i < PERF_COUNTER_TYPES; i++)
+    {
+        if (counters->fd[i] < 0)
+            continue;
+
+        ioctl(counters->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+        if (read(counters->fd[i], reading, sizeof(reading)) == sizeof(reading) && reading[2] > 0)
+            counters->value[i] += (double) reading[0] * reading[1] / reading[2];
+
+        close(counters->fd[i]);
+        counters->fd[i] = -1;
+    }
+}
+
+static inline void addPerfCounters (struct perf_counters_s *total, struct perf_counters_s *counters)
+{
+    for (int i = 0; i < PERF_COUNTER_TYPES; i++)
+    {
+        total->available[i] |= counters->available[i];
+        total->value[i] += counters->value[i];
+    }
+}
+
+// prints each counter per operation, after Mean/STD
+static inline void printPerfCounters (struct perf_counters_s *total, double operations)
+{
+    for (int i = 0; i < PERF_COUNTER_TYPES; i++)
+    {
+        if (total->available[i])
+            printf ("%s per Operation : %f\n", perfCounterNames[i], total->value[i] / operations);
+        else
+            printf ("%s per Operation : not available\n", perfCounterNames[i]);
+    }
+
+    if (total->available[PERF_CYCLES] && total->available[PERF_INSTRUCTIONS] && total->value[PERF_CYCLES] > 0)
+        printf ("Instructions per Cycle : %f\n", total->value[PERF_INSTRUCTIONS] / total->value[PERF_CYCLES]);
+}
+
+#endif
@@ -0,0 +1,217 @@
+#!/bin/sh
+#
+# regressionSuite
+#
+# Runs a fixed set of scenarios (programs x operation mixes x thread counts x
+# list sizes) and writes the Mean/STD and the number of samples of each to
+# <resultFile> as JSON, together with the CPU, core count, compiler, compiler
+# flags and git revision they were measured with. Every program runs once with
+# its output discarded before the first scenario, so that a cold machine does
+# not bias the first measurements.
+#
+# When <baselineFile> exists every scenario is compared with it. A scenario has
+# regressed when its mean grew by more than <tolerance> of the baseline mean
+# and by more than <sigmas> times the standard error of the difference of the
+# two means, sqrt(baseSTD^2 / baseSamples + STD^2 / samples), so slowdowns
+# within the noise of the measurement are not reported. The script exits with
+# 1 when any scenario regressed and with 2 when a program fails to build or run.
+#
+# Baselines are machine specific and default to baselines/<hostname>.json;
+# -u stores the results of the run as the new baseline. CFLAGS overrides the
+# compiler flags (default -O2 -Wall).
+#
+# Run : ./regressionSuite.sh [-o <resultFile>] [-b <baselineFile>] [-k <sigmas>] [-t <tolerance>] [-u]
+#
+
+resultFile=regressionResults.json
+baselineFile=baselines/$(hostname).json
+sigmas=3
+tolerance=0.05
+updateBaseline=0
+flags=${CFLAGS:-"-O2 -Wall"}
+
+m=5000
+sampleSize=35       # samples of the serial program; the others use their built-in sample size
+sizes="100 1000"
+threadCounts="1 2 4 8"
+mixes="read-heavy:0.99:0.005:0.005 read-mostly:0.9:0.05:0.05 write-heavy:0.5:0.25:0.25"
+
+while getopts "o:b:k:t:u" option
+do
+    case $option in
+        o) resultFile=$OPTARG ;;
+        b) baselineFile=$OPTARG ;;
+        k) sigmas=$OPTARG ;;
+        t) tolerance=$OPTARG ;;
+        u) updateBaseline=1 ;;
+        *) echo "Run : ./regressionSuite.sh [-o <resultFile>] [-b <baselineFile>] [-k <sigmas>] [-t <tolerance>] [-u]"
+           exit 2 ;;
+    esac
+done
+
+for program in SerialLinkedList LinkedListWithMutex LinkedListWithReadWriteLocks LinkedListWithSeqLock LinkedListWithHashIndex
+do
+    gcc $flags -o $program $program.c -lpthread -lm || exit 2
+done
+
+# escapes a string for a JSON value
+jsonString ()
+{
+    printf '"%s"' "$(printf '%s' "$1" | sed 's/\\/\\\\/g; s/"/\\"/g')"
+}
+
+cpu=$(awk -F': ' '/^model name/ { print $2; exit }' /proc/cpuinfo)
+cores=$(getconf _NPROCESSORS_ONLN)
+compiler=$(gcc --version | head -n 1)
+revision=$(git rev-parse HEAD 2>/dev/null || echo unknown)
+dirty=false
+if [ "$revision" != unknown ] && ! git diff --quiet HEAD -- '*.c' '*.h'
+then
+    dirty=true
+fi
+
+scenarios=$(mktemp)
+trap 'rm -f "$scenarios"' EXIT
+
+# prints the sample size a program is built with
+builtInSampleSize ()
+{
+    sed -n 's/^int sampleSize = \([0-9]*\);.*/\1/p' "$1.c"
+}
+
+# runs one scenario of <samples> samples and appends "name mean std samples"
+# to the scenario list
+runScenario ()
+{
+    name=$1
+    samples=$2
+    shift 2
+
+    output=$("$@") || { echo "$name failed" >&2; exit 2; }
+
+    echo "$output" | awk -F' : ' -v name="$name" -v samples="$samples" '
+        /^Mean/ { mean = $2 }
+        /^STD/ { std = $2 }
+        END { if (mean == "") exit 1; print name, mean, std, samples }' >> "$scenarios" || { echo "$name printed no Mean" >&2; exit 2; }
+
+    tail -n 1 "$scenarios"
+}
+
+mutexSamples=$(builtInSampleSize LinkedListWithMutex)
+rwlockSamples=$(builtInSampleSize LinkedListWithReadWriteLocks)
+seqlockSamples=$(builtInSampleSize LinkedListWithSeqLock)
+hashSamples=$(builtInSampleSize LinkedListWithHashIndex)
+
+# one discarded run of every program before any sample is kept, so that a
+# cold machine (clock ramp-up, page cache, first page faults) does not slow
+# down the first scenarios and make a later run look improved
+warmUpSize=${sizes##* }
+warmUpThreads=${threadCounts##* }
+warmUpFractions=$(echo "${mixes##* }" | cut -d: -f2- | tr ':' ' ')
+
+echo "Warm-up"
+./SerialLinkedList -s $sampleSize $warmUpSize $m $warmUpFractions > /dev/null || { echo "SerialLinkedList failed" >&2; exit 2; }
+./LinkedListWithMutex $warmUpSize $m $warmUpThreads $warmUpFractions > /dev/null || { echo "LinkedListWithMutex failed" >&2; exit 2; }
+./LinkedListWithReadWriteLocks $warmUpSize $m $warmUpThreads $warmUpFractions > /dev/null || { echo "LinkedListWithReadWriteLocks failed" >&2; exit 2; }
+./LinkedListWithSeqLock $warmUpSize $m $warmUpThreads $warmUpFractions > /dev/null || { echo "LinkedListWithSeqLock failed" >&2; exit 2; }
+./LinkedListWithHashIndex -e hash $warmUpSize $m $warmUpThreads $warmUpFractions > /dev/null || { echo "LinkedListWithHashIndex failed" >&2; exit 2; }
+
+echo "Scenario Mean STD Samples"
+
+for mix in $mixes
+do
+    mixName=${mix%%:*}
+    fractions=$(echo "${mix#*:}" | tr ':' ' ')
+
+    for n in $sizes
+    do
+        runScenario "serial/$mixName/n$n/t1" $sampleSize ./SerialLinkedList -s $sampleSize $n $m $fractions
+
+        for threadCount in $threadCounts
+        do
+            suffix="$mixName/n$n/t$threadCount"
+            runScenario "mutex/$suffix" $mutexSamples ./LinkedListWithMutex $n $m $threadCount $fractions
+            runScenario "rwlock/$suffix" $rwlockSamples ./LinkedListWithReadWriteLocks $n $m $threadCount $fractions
+            runScenario "seqlock/$suffix" $seqlockSamples ./LinkedListWithSeqLock $n $m $threadCount $fractions
+            runScenario "hash/$suffix" $hashSamples ./LinkedListWithHashIndex -e hash $n $m $threadCount $fractions
+        done
+    done
+done
+
+# one scenario per line, so that the file can be compared with line tools
+{
+    echo "{"
+    echo "  \"environment\": {"
+    echo "    \"cpu\": $(jsonString "$cpu"),"
+    echo "    \"cores\": $cores,"
+    echo "    \"compiler\": $(jsonString "$compiler"),"
+    echo "    \"flags\": $(jsonString "$flags"),"
+    echo "    \"git\": $(jsonString "$revision"),"
+    echo "    \"gitDirty\": $dirty,"
+    echo "    \"kernel\": $(jsonString "$(uname -r)"),"
+    echo "    \"date\": $(jsonString "$(date -u +%Y-%m-%dT%H:%M:%SZ)")"
+    echo "  },"
+    echo "  \"m\": $m,"
+    echo "  \"scenarios\": ["
+    awk '{ printf "%s    { \"name\": \"%s\", \"mean\": %s, \"std\": %s, \"samples\": %s }", (NR > 1 ? ",\n" : ""), $1, $2, $3, $4 }
+         END { print "" }' "$scenarios"
+    echo "  ]"
+    echo "}"
+} > "$resultFile"
+
+echo "Results : $resultFile"
+
+status=0
+
+if [ -f "$baselineFile" ]
+then
+    # the same code is only comparable on the same machine and flags
+    for field in cpu cores flags
+    do
+        if [ "$(grep "\"$field\":" "$baselineFile")" != "$(grep "\"$field\":" "$resultFile")" ]
+        then
+            echo "Warning : the baseline was recorded with a different $field"
+        fi
+    done
+
+    printf "%-34s %-14s %-14s %-10s %s\n" "Scenario" "Baseline Mean" "Mean" "Change" "Status"
+
+    sed -n 's/.*"name": "\([^"]*\)", "mean": \([^,]*\), "std": \([^,]*\), "samples": \([0-9]*\) }.*/\1 \2 \3 \4/p' "$baselineFile" |
+        awk -v sigmas="$sigmas" -v tolerance="$tolerance" '
+            NR == FNR { baseMean[$1] = $2; baseStd[$1] = $3; baseSamples[$1] = $4; next }
+            !($1 in baseMean) { printf "%-34s %-14s %-14s %-10s %s\n", $1, "-", $2, "-", "new"; next }
+            {
+                # standard error of the difference of the two means
+                difference = $2 - baseMean[$1]
+                noise = sigmas * sqrt(baseStd[$1] ^ 2 / baseSamples[$1] + $3 ^ 2 / $4)
+                change = baseMean[$1] > 0 ? difference / baseMean[$1] : 0
+                status = "ok"
+
+                if (difference > noise && change > tolerance)
+                {
+                    status = "REGRESSION"
+                    regressions++
+                }
+                else if (-difference > noise && -change > tolerance)
+                    status = "improved"
+
+                printf "%-34s %-14s %-14s %-10s %s\n", $1, baseMean[$1], $2, sprintf("%+.1f%%", change * 100), status
+            }
+            END { exit regressions > 0 }' - "$scenarios" || status=1
+
+    if [ $status -ne 0 ]
+    then
+        echo "Regressions found against $baselineFile"
+    fi
+else
+    echo "No baseline at $baselineFile"
+fi
+
+if [ $updateBaseline -eq 1 ]
+then
+    mkdir -p "$(dirname "$baselineFile")"
+    cp "$resultFile" "$baselineFile"
+    echo "Baseline : $baselineFile"
+fi
+
+exit $status